@@ -0,0 +1,53 @@
+#pragma once
+
+#include <benchmark/benchmark.h>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include "book_database.hpp"
+#include "catalog_generator.hpp"
+
+namespace bookdb::bench {
+
+// Размеры каталогов от 1K до 100M строк. Верхняя граница по умолчанию - 1M, чтобы прогон
+// умещался в память рабочей машины; полный диапазон - BOOKDB_BENCH_MAX_ROWS=100000000
+inline int64_t MaxRows() {
+    const char *env = std::getenv("BOOKDB_BENCH_MAX_ROWS");
+    return env ? std::strtoll(env, nullptr, 10) : 1'000'000;
+}
+
+inline void CatalogSizes(benchmark::internal::Benchmark *ioBench) {
+    for (int64_t rows = 1'000; rows <= 100'000'000 && rows <= MaxRows(); rows *= 10)
+        ioBench->Arg(rows);
+    ioBench->ArgName("rows");
+}
+
+// Каталог по умолчанию с заданным числом строк, авторов - примерно строк / 20
+inline CatalogOptions CatalogFor(int64_t iRows) {
+    CatalogOptions opt;
+    opt.rows = static_cast<size_t>(iRows);
+    opt.authors = std::max<size_t>(10, opt.rows / 20);
+    return opt;
+}
+
+// Генерация каталога дорогая, поэтому последний построенный каталог каждого типа кешируется.
+// Хранится только один размер, чтобы 100M строк не держали в памяти все меньшие каталоги
+template <BookContainerLike T = std::vector<Book>>
+const BookDatabase<T> &CachedCatalog(int64_t iRows) {
+    static std::unique_ptr<BookDatabase<T>> db;
+    static int64_t rows = -1;
+    if (rows != iRows) {
+        db.reset();
+        db = std::make_unique<BookDatabase<T>>();
+        generateCatalog(*db, CatalogFor(iRows));
+        rows = iRows;
+    }
+    return *db;
+}
+
+inline void SetRowsProcessed(benchmark::State &ioState) {
+    ioState.SetItemsProcessed(ioState.iterations() * ioState.range(0));
+}
+}  // namespace bookdb::bench
@@ -0,0 +1,148 @@
+#include <filesystem>
+
+#include "bench_common.hpp"
+#include "book_exporter.hpp"
+#include "book_loader.hpp"
+#include "columnar_book_container.hpp"
+#include "cow_array.hpp"
+#include "snapshot.hpp"
+
+using namespace bookdb;
+using namespace bookdb::bench;
+
+namespace {
+template <BookContainerLike T>
+void BM_PushBack(benchmark::State &state) {
+    const auto &source = CachedCatalog(state.range(0)).GetBooks();
+    for (auto _ : state) {
+        BookDatabase<T> db;
+        for (const auto &book : source)
+            db.PushBack(book);
+        benchmark::DoNotOptimize(db.size());
+    }
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_PushBack<std::vector<Book>>)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PushBack<ColumnarBookContainer>)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PushBack<CowBookContainer>)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+
+template <BookContainerLike T>
+void BM_BulkInsert(benchmark::State &state) {
+    const auto &source = CachedCatalog(state.range(0)).GetBooks();
+    for (auto _ : state) {
+        BookDatabase<T> db;
+        db.BulkInsert(source);
+        benchmark::DoNotOptimize(db.size());
+    }
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_BulkInsert<std::vector<Book>>)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BulkInsert<ColumnarBookContainer>)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+
+void BM_EnableIndexes(benchmark::State &state) {
+    auto db = CachedCatalog(state.range(0));
+    for (auto _ : state) {
+        db.EnableIndexes();
+        benchmark::DoNotOptimize(db.GetIndexes());
+    }
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_EnableIndexes)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+
+// Удаление каждой десятой книги и уплотнение шагами по умолчанию
+void BM_EraseAndCompact(benchmark::State &state) {
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto db = CachedCatalog(state.range(0));
+        state.ResumeTiming();
+        for (BookId id = 0; id < db.size(); id += 10)
+            db.Erase(id);
+        while (!db.CompactStep())
+            ;
+        benchmark::DoNotOptimize(db.size());
+    }
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_EraseAndCompact)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+
+// Снимок и одна запись после него: с копированием при записи писатель копирует список кусков
+// и один кусок, с вектором снимок копирует все книги
+template <BookContainerLike T>
+void BM_SnapshotThenWrite(benchmark::State &state) {
+    BookDatabase<T> db = CachedCatalog<T>(state.range(0));
+    for (auto _ : state) {
+        const auto snapshot = db.TakeSnapshot();
+        db.Update(0, BookUpdate{.read_count = 1});
+        benchmark::DoNotOptimize(snapshot->size());
+    }
+}
+BENCHMARK(BM_SnapshotThenWrite<std::vector<Book>>)->Apply(CatalogSizes)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_SnapshotThenWrite<CowBookContainer>)->Apply(CatalogSizes)->Unit(benchmark::kMicrosecond);
+
+void BM_LoadCsv(benchmark::State &state) {
+    const std::string csv = generateCatalogCsv(CatalogFor(state.range(0)));
+    for (auto _ : state) {
+        BookDatabase<std::vector<Book>> db;
+        benchmark::DoNotOptimize(loadBooks(db, csv).rows_loaded);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(csv.size()));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_LoadCsv)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Приёмник только считает байты, поэтому измеряется сама сериализация
+void BM_Export(benchmark::State &state, ExportFormat iFormat) {
+    const auto &db = CachedCatalog(state.range(0));
+    size_t bytes = 0;
+    for (auto _ : state)
+        bytes += exportBooks(db, [](std::string_view iText) { benchmark::DoNotOptimize(iText.data()); },
+                             ExportOptions{.format = iFormat})
+                     .bytes_written;
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    SetRowsProcessed(state);
+}
+BENCHMARK_CAPTURE(BM_Export, Csv, ExportFormat::Csv)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK_CAPTURE(BM_Export, JsonLines, ExportFormat::JsonLines)
+    ->Apply(CatalogSizes)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+class SnapshotFixture : public benchmark::Fixture {
+public:
+    void SetUp(const benchmark::State &state) override {
+        saveSnapshot(CachedCatalog(state.range(0)), path);
+    }
+    void TearDown(const benchmark::State &) override { std::filesystem::remove(path); }
+
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "bookdb_bench.snapshot";
+};
+
+BENCHMARK_DEFINE_F(SnapshotFixture, Open)(benchmark::State &state) {
+    for (auto _ : state) {
+        const Snapshot snapshot(path);
+        benchmark::DoNotOptimize(snapshot.size());
+    }
+    SetRowsProcessed(state);
+}
+BENCHMARK_REGISTER_F(SnapshotFixture, Open)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_DEFINE_F(SnapshotFixture, LoadIntoDatabase)(benchmark::State &state) {
+    for (auto _ : state) {
+        BookDatabase<std::vector<Book>> db;
+        loadSnapshot(db, path);
+        benchmark::DoNotOptimize(db.size());
+    }
+    SetRowsProcessed(state);
+}
+BENCHMARK_REGISTER_F(SnapshotFixture, LoadIntoDatabase)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+
+void BM_SaveSnapshot(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    const auto path = std::filesystem::temp_directory_path() / "bookdb_bench_save.snapshot";
+    for (auto _ : state)
+        saveSnapshot(db, path);
+    std::filesystem::remove(path);
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_SaveSnapshot)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond)->UseRealTime();
+}  // namespace
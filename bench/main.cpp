@@ -0,0 +1,5 @@
+#include <benchmark/benchmark.h>
+
+// Результаты для сравнения между релизами:
+// BookDB_bench --benchmark_out=results.json --benchmark_out_format=json
+BENCHMARK_MAIN();
@@ -0,0 +1,173 @@
+#include "author_completion.hpp"
+#include "bench_common.hpp"
+#include "book_sampler.hpp"
+#include "bitmap_filter.hpp"
+#include "columnar_book_container.hpp"
+#include "comparators.hpp"
+#include "filters.hpp"
+#include "order_index.hpp"
+#include "query_planner.hpp"
+#include "statsistics.hpp"
+#include "title_index.hpp"
+#include "top_k.hpp"
+
+using namespace bookdb;
+using namespace bookdb::bench;
+
+namespace {
+const auto kQuery = all_of(YearBetween(1900, 1999), RatingAbove(4.5));
+
+void BM_FilterBooksScan(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(filterBooks(db.cbegin(), db.cend(), kQuery));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_FilterBooksScan)->Apply(CatalogSizes);
+
+// Время до первого совпадения ленивой выборки не зависит от размера базы
+void BM_FilterViewFirstMatch(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state) {
+        auto matches = filterView(db.cbegin(), db.cend(), kQuery);
+        benchmark::DoNotOptimize(matches.begin());
+    }
+}
+BENCHMARK(BM_FilterViewFirstMatch)->Apply(CatalogSizes);
+
+void BM_CountBooksScan(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(countBooks(db.cbegin(), db.cend(), kQuery));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_CountBooksScan)->Apply(CatalogSizes);
+
+void BM_FilterBooksPlanned(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(filterBooks(db, kQuery));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_FilterBooksPlanned)->Apply(CatalogSizes);
+
+void BM_FilterBooksIndexed(benchmark::State &state) {
+    auto db = CachedCatalog(state.range(0));
+    db.EnableIndexes();
+    const auto query = all_of(AuthorIs("Author 7"), RatingAbove(4.));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(filterBooks(db, query));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_FilterBooksIndexed)->Apply(CatalogSizes);
+
+// Каталог, кластеризованный по году: сводки блоков отбрасывают всё вне диапазона лет
+void BM_FilterBooksZoned(benchmark::State &state) {
+    auto db = CachedCatalog(state.range(0));
+    db.EnableZoneMap();
+    db.ClusterBy(comp::LessByYear{});
+    for (auto _ : state)
+        benchmark::DoNotOptimize(filterBooks(db, all_of(YearBetween(1990, 1999), RatingAbove(4.5))));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_FilterBooksZoned)->Apply(CatalogSizes);
+
+void BM_SearchTitlesScan(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(searchTitles(db, "title 123", {.limit = 10}));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_SearchTitlesScan)->Apply(CatalogSizes);
+
+void BM_SearchTitlesIndexed(benchmark::State &state) {
+    auto db = CachedCatalog(state.range(0));
+    db.EnableTitleIndex();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(searchTitles(db, "title 123", {.limit = 10}));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_SearchTitlesIndexed)->Apply(CatalogSizes);
+
+void BM_AuthorComplete(benchmark::State &state) {
+    const auto completion = buildAuthorCompletion(CachedCatalog(state.range(0)));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(completion.Complete("Author 1", 10));
+}
+BENCHMARK(BM_AuthorComplete)->Apply(CatalogSizes);
+
+void BM_SelectBooksColumnar(benchmark::State &state) {
+    const auto &db = CachedCatalog<ColumnarBookContainer>(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(selectBooks(db, kQuery).Count());
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_SelectBooksColumnar)->Apply(CatalogSizes);
+
+// getTopNBy кластеризует базу, поэтому каждая итерация начинает с нетронутой копии
+void BM_GetTopNBy(benchmark::State &state) {
+    const auto &source = CachedCatalog(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto db = source;
+        state.ResumeTiming();
+        benchmark::DoNotOptimize(getTopNBy(db, 10, comp::GreaterByRating{}));
+    }
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_GetTopNBy)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+
+void BM_GetTopKBy(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(getTopKBy(db, 10, comp::GreaterByRating{}));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_GetTopKBy)->Apply(CatalogSizes)->UseRealTime();
+
+void BM_SortByAuthorRank(benchmark::State &state) {
+    const auto &source = CachedCatalog(state.range(0));
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto db = source;
+        state.ResumeTiming();
+        const auto ranks = db.GetAuthors().BuildRanks();
+        std::sort(db.begin(), db.end(), comp::LessByAuthorRank{ranks});
+    }
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_SortByAuthorRank)->Apply(CatalogSizes)->Unit(benchmark::kMillisecond);
+
+void BM_OrderedTop100Sort(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(orderedBookIds(db, comp::GreaterByRating{}, 100));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_OrderedTop100Sort)->Apply(CatalogSizes);
+
+void BM_OrderedTop100Indexed(benchmark::State &state) {
+    auto db = CachedCatalog(state.range(0));
+    db.EnableOrderIndex<comp::GreaterByRating>();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(orderedBookIds(db, comp::GreaterByRating{}, 100));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_OrderedTop100Indexed)->Apply(CatalogSizes);
+
+void BM_SampleRandomBooks(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sampleRandomBooks(db, 100));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_SampleRandomBooks)->Apply(CatalogSizes);
+
+void BM_BookSamplerDraw(benchmark::State &state) {
+    const BookSampler sampler(CachedCatalog(state.range(0)), SampleWeight::ReadCount);
+    std::mt19937_64 gen{42};
+    for (auto _ : state)
+        benchmark::DoNotOptimize(sampler.Sample(100, gen));
+}
+BENCHMARK(BM_BookSamplerDraw)->Apply(CatalogSizes);
+}  // namespace
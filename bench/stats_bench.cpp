@@ -0,0 +1,80 @@
+#include "bench_common.hpp"
+#include "columnar_book_container.hpp"
+#include "parallel_statistics.hpp"
+#include "sketches.hpp"
+#include "statsistics.hpp"
+
+using namespace bookdb;
+using namespace bookdb::bench;
+
+namespace {
+template <BookContainerLike T>
+void BM_AuthorHistogram(benchmark::State &state) {
+    const auto &db = CachedCatalog<T>(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(buildAuthorHistogramFlat(db));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_AuthorHistogram<std::vector<Book>>)->Apply(CatalogSizes);
+BENCHMARK(BM_AuthorHistogram<ColumnarBookContainer>)->Apply(CatalogSizes);
+
+void BM_AuthorHistogramParallel(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(buildAuthorHistogramFlatParallel(db));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_AuthorHistogramParallel)->Apply(CatalogSizes)->UseRealTime();
+
+void BM_CatalogSketches(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(buildCatalogSketches(db.GetBooks()));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_CatalogSketches)->Apply(CatalogSizes)->UseRealTime();
+
+void BM_GenreRatings(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calculateGenreRatings(db.cbegin(), db.cend()));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_GenreRatings)->Apply(CatalogSizes);
+
+void BM_GenreRatingsParallel(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calculateGenreRatingsParallel(db.cbegin(), db.cend()));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_GenreRatingsParallel)->Apply(CatalogSizes)->UseRealTime();
+
+template <BookContainerLike T>
+void BM_AverageRating(benchmark::State &state) {
+    const auto &db = CachedCatalog<T>(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calculateAverageRating(db));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_AverageRating<std::vector<Book>>)->Apply(CatalogSizes);
+BENCHMARK(BM_AverageRating<ColumnarBookContainer>)->Apply(CatalogSizes);
+
+void BM_AverageRatingParallel(benchmark::State &state) {
+    const auto &db = CachedCatalog(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calculateAverageRatingParallel(db));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_AverageRatingParallel)->Apply(CatalogSizes)->UseRealTime();
+
+// С включёнными агрегатами запросы не проходят по книгам
+void BM_AverageRatingAggregated(benchmark::State &state) {
+    auto db = CachedCatalog(state.range(0));
+    db.EnableAggregates();
+    for (auto _ : state)
+        benchmark::DoNotOptimize(calculateAverageRating(db));
+    SetRowsProcessed(state);
+}
+BENCHMARK(BM_AverageRatingAggregated)->Apply(CatalogSizes);
+}  // namespace
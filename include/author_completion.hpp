@@ -0,0 +1,192 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <numeric>
+#include <queue>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "author_dictionary.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "heterogeneous_lookup.hpp"
+
+namespace bookdb {
+
+struct AuthorCompletionEntry {
+    AuthorId id;
+    std::string_view name;
+    uint64_t read_count;
+};
+
+// Индекс автодополнения по авторам: имена отсортированы в плоском массиве, рядом лежат
+// первые 8 байт каждого имени как число - бинарный поиск почти всегда сравнивает их,
+// не переходя по указателю на строку. Лучшие по read_count авторы среди имён с префиксом
+// ищутся деревом отрезков максимумов за O(N log M), а не сортировкой всех совпадений.
+// Индекс неизменяемый: после вставки книг его нужно построить заново
+class AuthorCompletion {
+public:
+    AuthorCompletion() = default;
+
+    // iReadCounts[id] - суммарный read_count автора с номером id
+    AuthorCompletion(const AuthorDictionary &iAuthors, std::span<const uint64_t> iReadCounts) {
+        if (iReadCounts.size() != iAuthors.size())
+            throw std::runtime_error{"Read counts do not match the author dictionary"};
+        ids_.resize(iAuthors.size());
+        std::iota(ids_.begin(), ids_.end(), AuthorId{0});
+        std::ranges::sort(ids_, TransparentStringLess{}, [&](AuthorId id) { return iAuthors.GetName(id); });
+
+        names_.reserve(ids_.size());
+        heads_.reserve(ids_.size());
+        read_counts_.reserve(ids_.size());
+        for (AuthorId id : ids_) {
+            names_.push_back(iAuthors.GetName(id));
+            heads_.push_back(Head(names_.back()));
+            read_counts_.push_back(iReadCounts[id]);
+        }
+        BuildTree();
+    }
+
+    size_t size() const noexcept { return ids_.size(); }
+    bool empty() const noexcept { return ids_.empty(); }
+
+    // Точный поиск; принимает string_view, std::string и const char*. kNoAuthorId, если автора нет
+    template <typename K>
+        requires std::convertible_to<const K &, std::string_view>
+    AuthorId Find(const K &iName) const {
+        const std::string_view name = iName;
+        const size_t pos = LowerBound(name);
+        return pos < names_.size() && names_[pos] == name ? ids_[pos] : kNoAuthorId;
+    }
+
+    // Номера авторов с именем на iPrefix в лексикографическом порядке имён
+    std::span<const AuthorId> WithPrefix(std::string_view iPrefix) const {
+        const auto [first, last] = PrefixRange(iPrefix);
+        return std::span(ids_).subspan(first, last - first);
+    }
+
+    // До iCount авторов с именем на iPrefix по убыванию read_count, при равенстве - по имени
+    std::vector<AuthorCompletionEntry> Complete(std::string_view iPrefix, size_t iCount) const {
+        std::vector<AuthorCompletionEntry> res;
+        const auto [first, last] = PrefixRange(iPrefix);
+        if (first == last || iCount == 0)
+            return res;
+
+        // В куче лежат отрезки позиций вместе с лучшей позицией отрезка
+        struct Range {
+            size_t begin, end, best;
+        };
+        auto worse = [this](const Range &lhv, const Range &rhv) { return Better(rhv.best, lhv.best); };
+        std::priority_queue<Range, std::vector<Range>, decltype(worse)> heap(worse);
+        heap.push({first, last, ArgMax(first, last)});
+        while (!heap.empty() && res.size() < iCount) {
+            const Range range = heap.top();
+            heap.pop();
+            res.push_back({ids_[range.best], names_[range.best], read_counts_[range.best]});
+            if (range.begin < range.best)
+                heap.push({range.begin, range.best, ArgMax(range.begin, range.best)});
+            if (range.best + 1 < range.end)
+                heap.push({range.best + 1, range.end, ArgMax(range.best + 1, range.end)});
+        }
+        return res;
+    }
+
+private:
+    // Первые 8 байт имени в порядке старшинства, недостающие байты - нули.
+    // Из Head(a) < Head(b) следует a < b, при равенстве сравниваются сами строки
+    static uint64_t Head(std::string_view iName) noexcept {
+        uint64_t res = 0;
+        for (size_t i = 0; i < sizeof(uint64_t); ++i)
+            res = res << 8 | (i < iName.size() ? static_cast<uint8_t>(iName[i]) : 0);
+        return res;
+    }
+
+    size_t LowerBound(std::string_view iKey) const {
+        const uint64_t head = Head(iKey);
+        size_t lo = 0, hi = names_.size();
+        while (lo < hi) {
+            const size_t mid = lo + (hi - lo) / 2;
+            const bool less = heads_[mid] != head ? heads_[mid] < head : names_[mid] < iKey;
+            if (less)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        return lo;
+    }
+
+    // Имена с общим префиксом идут в отсортированном массиве подряд
+    std::pair<size_t, size_t> PrefixRange(std::string_view iPrefix) const {
+        const size_t first = LowerBound(iPrefix);
+        const auto it = std::partition_point(names_.begin() + first, names_.end(),
+                                             [&](std::string_view name) { return name.starts_with(iPrefix); });
+        return {first, static_cast<size_t>(it - names_.begin())};
+    }
+
+    bool Better(size_t lhv, size_t rhv) const noexcept {
+        return read_counts_[lhv] != read_counts_[rhv] ? read_counts_[lhv] > read_counts_[rhv] : lhv < rhv;
+    }
+
+    // Дерево отрезков снизу вверх: листья tree_[n + pos] = pos, узел - лучший из детей
+    void BuildTree() {
+        const size_t n = ids_.size();
+        tree_.resize(2 * n);
+        for (size_t pos = 0; pos < n; ++pos)
+            tree_[n + pos] = static_cast<uint32_t>(pos);
+        for (size_t node = n; node-- > 1;) {
+            const uint32_t l = tree_[2 * node], r = tree_[2 * node + 1];
+            tree_[node] = Better(l, r) ? l : r;
+        }
+    }
+
+    // Лучшая позиция в [iBegin, iEnd), отрезок не пуст
+    size_t ArgMax(size_t iBegin, size_t iEnd) const {
+        const size_t n = ids_.size();
+        size_t res = iBegin;
+        for (size_t l = iBegin + n, r = iEnd + n; l < r; l /= 2, r /= 2) {
+            if (l & 1) {
+                if (Better(tree_[l], res))
+                    res = tree_[l];
+                ++l;
+            }
+            if (r & 1) {
+                --r;
+                if (Better(tree_[r], res))
+                    res = tree_[r];
+            }
+        }
+        return res;
+    }
+
+    std::vector<AuthorId> ids_;
+    std::vector<std::string_view> names_;
+    std::vector<uint64_t> heads_;
+    std::vector<uint64_t> read_counts_;
+    std::vector<uint32_t> tree_;
+};
+
+// Строит индекс автодополнения по текущему содержимому базы
+template <BookContainerLike T>
+AuthorCompletion buildAuthorCompletion(const BookDatabase<T> &iDb) {
+    std::vector<uint64_t> readCounts(iDb.GetAuthors().size());
+    auto add = [&](AuthorId id, int readCount) { readCounts[id] += static_cast<uint64_t>(std::max(readCount, 0)); };
+    if constexpr (ColumnarBookContainerLike<T>) {
+        const auto ids = iDb.GetBooks().GetAuthorIds();
+        const auto counts = iDb.GetBooks().GetReadCounts();
+        for (size_t row = 0; row < ids.size(); ++row)
+            if (!iDb.IsErased(row))
+                add(ids[row], counts[row]);
+    } else {
+        RowId row = 0;
+        for (const auto &book : iDb)
+            if (!iDb.IsErased(row++))
+                add(book.author_id, book.read_count);
+    }
+    return AuthorCompletion(iDb.GetAuthors(), readCounts);
+}
+}  // namespace bookdb
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "book.hpp"
+#include "cow_array.hpp"
+#include "heterogeneous_lookup.hpp"
+
+namespace bookdb {
+
+// Словарь авторов базы: каждому имени сопоставлен плотный номер 0..size()-1 в порядке
+// первого появления. Книги хранят номер, поэтому группировка по автору - это индексация
+// массива счётчиков, а не хеширование строк. Сам словарь строки не владеет - имена
+// лежат в арене строк базы. Итерация идёт по именам в порядке номеров.
+// Копия разделяет с оригиналом имена и таблицу номеров: имена копируются кусками при записи,
+// таблица - целиком при первом новом авторе в копии или оригинале
+class AuthorDictionary {
+public:
+    using const_iterator = CowArray<std::string_view>::const_iterator;
+
+    const_iterator begin() const noexcept { return names_.begin(); }
+    const_iterator end() const noexcept { return names_.end(); }
+    size_t size() const noexcept { return names_.size(); }
+    bool empty() const noexcept { return names_.empty(); }
+
+    bool contains(std::string_view iName) const { return Find(iName) != kNoAuthorId; }
+
+    // kNoAuthorId, если такого автора нет
+    AuthorId Find(std::string_view iName) const { return Find(PrehashedString{iName, TransparentStringHash{}(iName)}); }
+    AuthorId Find(const PrehashedString &iName) const {
+        if (!ids_)
+            return kNoAuthorId;
+        auto it = ids_->find(iName);
+        return it != ids_->end() ? it->second : kNoAuthorId;
+    }
+
+    std::string_view GetName(AuthorId iId) const noexcept { return names_[iId]; }
+
+    // iName должен жить не меньше словаря; повторное добавление возвращает прежний номер
+    AuthorId Add(std::string_view iName) { return Add(PrehashedString{iName, TransparentStringHash{}(iName)}); }
+    AuthorId Add(const PrehashedString &iName) {
+        if (AuthorId id = Find(iName); id != kNoAuthorId)
+            return id;
+        if (names_.size() >= kNoAuthorId)
+            throw std::runtime_error{"Too many authors"};
+        const auto id = static_cast<AuthorId>(names_.size());
+        MutableIds().emplace(iName.str, id);
+        names_.push_back(iName.str);
+        return id;
+    }
+
+    // Место под iSize авторов без перехеширования таблицы по ходу добавления
+    void reserve(size_t iSize) {
+        names_.reserve(iSize);
+        MutableIds().reserve(iSize);
+    }
+
+    void clear() noexcept {
+        names_.clear();
+        ids_.reset();
+    }
+
+    // Ранг каждого автора в лексикографическом порядке имён: ranks[id]. Строки сравниваются
+    // один раз на словарь, после чего сортировка книг по автору сравнивает только числа
+    std::vector<AuthorId> BuildRanks() const {
+        std::vector<AuthorId> order(names_.size());
+        std::iota(order.begin(), order.end(), AuthorId{0});
+        std::sort(order.begin(), order.end(), [this](AuthorId l, AuthorId r) { return names_[l] < names_[r]; });
+
+        std::vector<AuthorId> ranks(names_.size());
+        for (size_t rank = 0; rank < order.size(); ++rank)
+            ranks[order[rank]] = static_cast<AuthorId>(rank);
+        return ranks;
+    }
+
+private:
+    using IdMap = std::unordered_map<std::string_view, AuthorId, TransparentStringHash, TransparentStringEqual>;
+
+    IdMap &MutableIds() {
+        if (!ids_)
+            ids_ = std::make_shared<IdMap>();
+        else if (!details::IsUniqueOwner(ids_))
+            ids_ = std::make_shared<IdMap>(*ids_);
+        return *ids_;
+    }
+
+    CowArray<std::string_view> names_;
+    std::shared_ptr<IdMap> ids_;
+};
+}  // namespace bookdb
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <concepts>
+#include <functional>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "filter_kernels.hpp"
+#include "filters.hpp"
+#include "metrics.hpp"
+#include "selection_bitmap.hpp"
+#include "zone_map.hpp"
+
+namespace bookdb {
+// Вычисляет предикат над всем контейнером и возвращает маску выбранных строк.
+// Распознанные предикаты над колоночным хранилищем считаются векторными ядрами,
+// all_of/any_of - побитовыми AND/OR масок, остальные предикаты - построчно без ветвлений
+template <BookContainerLike C, typename P>
+SelectionBitmap selectBooks(const C &iBooks, const P &iPred) {
+    SelectionBitmap res(iBooks.size());
+
+    if constexpr (ColumnarBookContainerLike<C> && std::same_as<P, pred::YearBetween>) {
+        kernels::YearBetween(iBooks.GetYears(), iPred.start, iPred.end, res.GetWords());
+    } else if constexpr (ColumnarBookContainerLike<C> && std::same_as<P, pred::RatingAbove>) {
+        kernels::RatingAbove(iBooks.GetRatings(), iPred.min_rating, res.GetWords());
+    } else if constexpr (ColumnarBookContainerLike<C> && std::same_as<P, pred::GenreIs>) {
+        kernels::GenreIs(iBooks.GetGenres(), iPred.genre, res.GetWords());
+    } else if constexpr (details::IsAllOf<P>) {
+        res.Flip();
+        // Как только маска опустела, остальные конъюнкты не вычисляются
+        std::apply([&](const auto &...p) { ((res.Any() ? void(res &= selectBooks(iBooks, p)) : void()), ...); },
+                   iPred.preds);
+    } else if constexpr (details::IsAnyOf<P>) {
+        std::apply([&](const auto &...p) { ((res |= selectBooks(iBooks, p)), ...); }, iPred.preds);
+    } else {
+        auto words = res.GetWords();
+        size_t i = 0;
+        for (const auto &book : iBooks) {
+            words[i / SelectionBitmap::kWordBits] |= SelectionBitmap::Word{static_cast<bool>(iPred(book))}
+                                                     << (i % SelectionBitmap::kWordBits);
+            ++i;
+        }
+    }
+    return res;
+}
+
+// Удалённые строки не выбираются. Со сводками блоков базы блоки, где предикат не выполняется, не читаются
+template <BookContainerLike T, typename P>
+SelectionBitmap selectBooks(const BookDatabase<T> &iDb, const P &iPred) {
+    BOOKDB_METRIC_TIMER(Filter);
+    size_t scanned = iDb.size();
+    std::optional<SelectionBitmap> zoned;
+    if (const ZoneMap *zones = iDb.GetZoneMap())
+        zoned = details::SelectZoned(iDb.GetBooks(), *zones, iPred, iPred, scanned);
+    SelectionBitmap res = zoned ? std::move(*zoned) : selectBooks(iDb.GetBooks(), iPred);
+    if (iDb.GetErasedCount())
+        res.AndNot(iDb.GetTombstones());
+    BOOKDB_METRIC_ADD(FilterCalls, 1);
+    BOOKDB_METRIC_ADD(RowsScanned, scanned);
+    BOOKDB_METRIC_ADD(RowsSelected, res.Count());
+    return res;
+}
+
+// Подсчёт по маске: ни индексов, ни ссылок на книги не создаётся
+template <BookContainerLike T, typename P>
+size_t countBooks(const BookDatabase<T> &iDb, const P &iPred) {
+    return selectBooks(iDb, iPred).Count();
+}
+
+// Выборка по базе идёт через планировщик запросов (query_planner.hpp). Объявления здесь нужны,
+// чтобы для базы всегда выбиралась эта перегрузка, а не общая ниже, в каком бы порядке
+// ни подключались заголовки
+template <BookContainerLike T, typename P>
+std::vector<RowId> filterBookIds(const BookDatabase<T> &iDb, const P &iPred);
+
+template <BookContainerLike T, typename P>
+    requires std::is_lvalue_reference_v<typename T::reference>
+std::vector<std::reference_wrapper<const Book>> filterBooks(const BookDatabase<T> &iDb, const P &iPred);
+
+// Материализация выполняется один раз, уже после объединения всех масок
+template <typename Books, typename P>
+std::vector<RowId> filterBookIds(const Books &iBooks, const P &iPred) {
+    return selectBooks(iBooks, iPred).ToIndices();
+}
+}  // namespace bookdb
+
+#include "query_planner.hpp"
@@ -1,14 +1,39 @@
 #pragma once
 
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
 #include <flat_map>
 #include <format>
+#include <limits>
 #include <stdexcept>
 #include <string_view>
+#include <tuple>
 
 namespace bookdb {
 using namespace std::literals;
 
 enum class Genre { Fiction, NonFiction, SciFi, Biography, Mystery, Unknown };
+inline constexpr size_t kGenreCount = static_cast<size_t>(Genre::Unknown) + 1;
+
+// Плотный номер автора в словаре базы
+using AuthorId = uint32_t;
+inline constexpr AuthorId kNoAuthorId = std::numeric_limits<AuthorId>::max();
+
+namespace details {
+// Жанры вне перечисления учитываются как Unknown
+constexpr size_t GenreSlot(Genre iGenre) noexcept {
+    const auto slot = static_cast<size_t>(iGenre);
+    return slot < kGenreCount ? slot : kGenreCount - 1;
+}
+}  // namespace details
+
+// Имена жанров по слотам: без выделения памяти, в том числе во время компиляции
+inline constexpr std::array<std::string_view, kGenreCount> kGenreNames{"Fiction"sv,   "NonFiction"sv, "SciFi"sv,
+                                                                       "Biography"sv, "Mystery"sv,    "Unknown"sv};
+
+constexpr std::string_view GenreName(Genre iGenre) noexcept { return kGenreNames[details::GenreSlot(iGenre)]; }
 
 // Ваш код для constexpr преобразования строк в enum::Genre и наоборот здесь
 constexpr Genre GenreFromString(std::string_view iS) {
@@ -22,51 +47,38 @@ constexpr Genre GenreFromString(std::string_view iS) {
     return Genre::Unknown;
 }
 
-constexpr std::string GenreToString(Genre iG) {
-    std::string res;
-    switch (iG) {
-    case Genre::Fiction:
-        res = "Fiction";
-        break;
-    case Genre::Mystery:
-        res = "Mystery";
-        break;
-    case Genre::NonFiction:
-        res = "NonFiction";
-        break;
-    case Genre::SciFi:
-        res = "SciFi"sv;
-        break;
-    case Genre::Biography:
-        res = "Biography";
-        break;
-    case Genre::Unknown:
-    default:
-        res = "Unknown";
-        break;
-    }
-    return res;
-}
+// Владеющая строка; без выделения памяти - GenreName
+constexpr std::string GenreToString(Genre iG) { return std::string(GenreName(iG)); }
 
 struct Book {
-    // string_view для экономии памяти, чтобы ссылаться на оригинальную строку, хранящуюся в другом контейнере
-    std::string title;
+    // string_view для экономии памяти, чтобы ссылаться на оригинальную строку, хранящуюся в другом контейнере.
+    // BookDatabase при вставке копирует и название, и автора в свою арену строк
+    std::string_view title;
     std::string_view author;
 
     double rating;
     int year;
     int read_count;
     Genre genre;
+    // Номер автора в словаре BookDatabase, назначается при вставке. У книг вне базы - kNoAuthorId
+    AuthorId author_id = kNoAuthorId;
 
-    constexpr Book(const std::string &iTitle, std::string_view iAuthor, int iYear, Genre iGenre, double iRating,
+    constexpr Book(std::string_view iTitle, std::string_view iAuthor, int iYear, Genre iGenre, double iRating,
                    int iReadCount)
         : title(iTitle), author(iAuthor), rating(iRating), year(iYear), read_count(iReadCount), genre(iGenre) {}
 
-    constexpr Book(const std::string &iTitle, std::string_view iAuthor, int iYear, std::string_view iGenre,
+    constexpr Book(std::string_view iTitle, std::string_view iAuthor, int iYear, std::string_view iGenre,
                    double iRating, int iReadCount)
         : Book(iTitle, iAuthor, iYear, GenreFromString(iGenre), iRating, iReadCount) {}
 
-    auto operator<=>(const Book &rhv) const = default;
+    // author_id зависит от базы, в которую попала книга, поэтому в сравнении не участвует
+    constexpr std::partial_ordering operator<=>(const Book &rhv) const { return Tie() <=> rhv.Tie(); }
+    constexpr bool operator==(const Book &rhv) const { return Tie() == rhv.Tie(); }
+
+private:
+    using Fields = std::tuple<const std::string_view &, const std::string_view &, const double &, const int &,
+                              const int &, const Genre &>;
+    constexpr Fields Tie() const { return {title, author, rating, year, read_count, genre}; }
 };
 }  // namespace bookdb
 
@@ -75,8 +87,7 @@ template <>
 struct formatter<bookdb::Genre, char> {
     template <typename FormatContext>
     auto format(const bookdb::Genre g, FormatContext &fc) const {
-        const std::string genre_str = bookdb::GenreToString(g);
-        return format_to(fc.out(), "{}", genre_str);
+        return format_to(fc.out(), "{}", bookdb::GenreName(g));
     }
 
     constexpr auto parse(format_parse_context &ctx) {
@@ -90,8 +101,8 @@ struct formatter<bookdb::Book, char> {
     auto format(const bookdb::Book &iBook, FormatContext &fc) const {
         constexpr auto fmt("title : {}, Author : {}, year : {}, genre : {}, rating : {}, read_count : {}");
 
-        return format_to(fc.out(), fmt, iBook.title, iBook.author, iBook.year, GenreToString(iBook.genre), iBook.rating,
-                         iBook.read_count);
+        return format_to(fc.out(), fmt, iBook.title, iBook.author, iBook.year, bookdb::GenreName(iBook.genre),
+                         iBook.rating, iBook.read_count);
     }
 
     constexpr auto parse(format_parse_context &ctx) {
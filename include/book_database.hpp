@@ -1,21 +1,79 @@
 #pragma once
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <optional>
 #include <print>
+#include <ranges>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <string_view>
-#include <unordered_set>
+#include <unordered_map>
 #include <vector>
 
+#include "author_dictionary.hpp"
 #include "book.hpp"
 #include "concepts.hpp"
+#include "cow_array.hpp"
 #include "heterogeneous_lookup.hpp"
+#include "metrics.hpp"
+#include "order_index.hpp"
+#include "running_aggregates.hpp"
+#include "secondary_index.hpp"
+#include "selection_bitmap.hpp"
+#include "sketches.hpp"
+#include "string_arena.hpp"
+#include "title_index.hpp"
+#include "zone_map.hpp"
 
 namespace bookdb {
 
+// Изменение числовых полей книги на месте; незаданные поля не меняются
+struct BookUpdate {
+    std::optional<int> year;
+    std::optional<double> rating;
+    std::optional<int> read_count;
+};
+
+// Итог уплотнения базы; байты - зарезервированные ареной строк до и после
+struct CompactionStats {
+    size_t rows_removed = 0;
+    size_t authors_released = 0;
+    size_t bytes_before = 0;
+    size_t bytes_after = 0;
+};
+
+namespace details {
+// Незавершённое уплотнение: теневая база и первая ещё не перенесённая строка.
+// Копия базы незавершённое уплотнение не наследует
+template <typename Db>
+struct CompactionSlot {
+    std::unique_ptr<Db> shadow;
+    RowId cursor = 0;
+
+    CompactionSlot() = default;
+    CompactionSlot(const CompactionSlot &) noexcept {}
+    CompactionSlot(CompactionSlot &&) noexcept = default;
+    CompactionSlot &operator=(const CompactionSlot &) noexcept {
+        shadow.reset();
+        cursor = 0;
+        return *this;
+    }
+    CompactionSlot &operator=(CompactionSlot &&) noexcept = default;
+};
+}  // namespace details
+
+// Каждая книга получает постоянный BookId. Удаление логическое: строка помечается в маске удалённых
+// и исчезает из выборок, статистик и агрегатов базы, но физически остаётся до уплотнения
+// (CompactStep/Compact). Итераторы и GetBooks обходят все физические строки, включая удалённые
 template <BookContainerLike BookContainer = std::vector<Book>>
 class BookDatabase {
 public:
-    using AuthorContainer = std::unordered_set<std::string, TransparentStringHash, TransparentStringEqual>;
+    // Имена авторов хранятся в арене строк базы, словарь держит string_view на них и их номера
+    using AuthorContainer = AuthorDictionary;
     using iterator = typename BookContainer::iterator;
     using reverse_iterator = typename BookContainer::reverse_iterator;
     using const_iterator = typename BookContainer::const_iterator;
@@ -43,35 +101,508 @@ public:
     size_t size() const noexcept { return books_.size(); }
     const AuthorContainer &GetAuthors() const noexcept { return authors_; }
     const BookContainer &GetBooks() const noexcept { return books_; }
+    const StringArena &GetStrings() const noexcept { return strings_; }
 
+    BookId GetBookId(RowId iRow) const noexcept { return book_ids_[iRow]; }
+    // Строка книги или kNoRow, если книга удалена или её не было
+    RowId FindRow(BookId iId) const noexcept { return iId < rows_by_id_.size() ? rows_by_id_[iId] : kNoRow; }
+    bool IsErased(RowId iRow) const noexcept { return erased_ && tombstones_.Test(iRow); }
+    size_t GetErasedCount() const noexcept { return erased_; }
+    size_t GetLiveCount() const noexcept { return books_.size() - erased_; }
+    // Маска удалённых строк размером size()
+    const SelectionBitmap &GetTombstones() const noexcept { return tombstones_; }
+    // Число живых книг каждого автора, индекс - номер автора. Авторы без книг остаются
+    // в словаре до уплотнения
+    std::span<const size_t> GetAuthorRefCounts() const noexcept { return author_refs_; }
+
+    // Вставка книги с бесконечным рейтингом или NaN бросает std::invalid_argument, база не меняется
     constexpr void PushBack(const value_type &iElem) {
+        BOOKDB_METRIC_TIMER(Insert);
+        CheckRating(iElem.rating);
         books_.push_back(iElem);
-        RegAuthor(books_.back());
+        OnInsert(books_.back());
     }
-    constexpr void PushBack(value_type &&iElem) noexcept(noexcept(books_.push_back(std::move(iElem)))) {
+    constexpr void PushBack(value_type &&iElem) {
+        BOOKDB_METRIC_TIMER(Insert);
+        CheckRating(iElem.rating);
         books_.push_back(std::move(iElem));
-        RegAuthor(books_.back());
+        OnInsert(books_.back());
     }
+    // Книга собирается до вставки, чтобы рейтинг проверялся раньше, чем она попадёт в хранилище
     template <typename... Args>
     constexpr reference EmplaceBack(Args &&...iArgs) {
-        reference ref = books_.emplace_back(std::forward<Args>(iArgs)...);
-        RegAuthor(ref);
+        BOOKDB_METRIC_TIMER(Insert);
+        value_type book(std::forward<Args>(iArgs)...);
+        CheckRating(book.rating);
+        reference ref = books_.emplace_back(std::move(book));
+        OnInsert(ref);
         return ref;
     }
+    // Пакетная вставка. Место под книги, новых авторов и названия резервируется один раз на пакет,
+    // имена авторов, ещё не связанных со словарём базы, хешируются отдельным проходом, а повторы
+    // внутри пакета схлопываются до обращения к словарю базы: каждый новый автор пакета ищется
+    // и добавляется в словарь один раз.
+    // Однопроходный диапазон сначала собирается в вектор. Рейтинги всего пакета проверяются
+    // до вставки: при бесконечном рейтинге или NaN бросается std::invalid_argument и база не меняется
+    template <std::ranges::input_range R>
+        requires std::convertible_to<std::ranges::range_reference_t<R>, value_type>
+    void BulkInsert(R &&iBooks) {
+        if constexpr (!std::ranges::forward_range<R>) {
+            std::vector<value_type> batch;
+            for (auto &&book : iBooks)
+                batch.push_back(static_cast<value_type>(book));
+            BulkInsert(batch);
+        } else {
+            BOOKDB_METRIC_TIMER(Insert);
+            const auto count = static_cast<size_t>(std::ranges::distance(iBooks));
+            // hashes[row] - хеш автора книги, которой предстоит поиск в словаре; книги, уже ссылающиеся
+            // на словарь базы (например, после loadBooks), не хешируются
+            std::vector<size_t> hashes(count);
+            std::vector<bool> pending(count);
+            size_t titleBytes = 0;
+            size_t row = 0;
+            for (auto &&ref : iBooks) {
+                const value_type &book = ref;
+                CheckRating(book.rating);
+                if (!IsInterned(book.author, book.author_id)) {
+                    hashes[row] = TransparentStringHash{}(book.author);
+                    pending[row] = true;
+                }
+                titleBytes += book.title.size();
+                ++row;
+            }
+
+            // slots[row] - номер различного автора пакета или kNoAuthorId, если книга уже ссылается на словарь базы
+            std::vector<AuthorId> slots(count, kNoAuthorId);
+            std::vector<PrehashedString> distinct;
+            std::unordered_map<std::string_view, AuthorId, TransparentStringHash, TransparentStringEqual> local;
+            row = 0;
+            for (auto &&ref : iBooks) {
+                const value_type &book = ref;
+                if (pending[row]) {
+                    const PrehashedString author{book.author, hashes[row]};
+                    auto it = local.find(author);
+                    if (it == local.end()) {
+                        it = local.emplace(book.author, static_cast<AuthorId>(distinct.size())).first;
+                        distinct.push_back(author);
+                    }
+                    slots[row] = it->second;
+                }
+                ++row;
+            }
+
+            authors_.reserve(authors_.size() + distinct.size());
+            std::vector<AuthorId> ids(distinct.size());
+            for (size_t slot = 0; slot < distinct.size(); ++slot)
+                ids[slot] = InternAuthor(distinct[slot]);
+
+            Reserve(books_.size() + count);
+            strings_.Reserve(titleBytes);
+            row = 0;
+            for (auto &&ref : iBooks) {
+                value_type book = ref;
+                if (const AuthorId slot = slots[row++]; slot != kNoAuthorId) {
+                    book.author_id = ids[slot];
+                    book.author = authors_.GetName(book.author_id);
+                }
+                book.title = strings_.Store(book.title);
+                books_.push_back(std::move(book));
+                UpdateDerived(books_.back());
+            }
+        }
+    }
+
+    // Логическое удаление: строка попадает в маску удалённых, агрегаты, сводки блоков, индексы
+    // порядка и счётчики авторов обновляются сразу, остальные индексы отсекают её по маске.
+    // false, если книги нет
+    bool Erase(BookId iId) {
+        const RowId row = FindRow(iId);
+        if (row == kNoRow)
+            return false;
+        const value_type book = GetBooks()[row];
+        tombstones_.Set(row);
+        ++erased_;
+        rows_by_id_[iId] = kNoRow;
+        --author_refs_[book.author_id];
+        if (aggregates_)
+            aggregates_->Erase(book);
+        order_indexes_.Erase(book, row);
+        if (zone_map_)
+            zone_map_->Erase(book, row);
+        if (compaction_.shadow && row < compaction_.cursor)
+            compaction_.shadow->Erase(iId);
+        return true;
+    }
+
+    // Изменение года, рейтинга и read_count на месте: номер строки и BookId сохраняются,
+    // индексы, агрегаты и сводки блоков обновляются точечно. Скетчи изменений не видят.
+    // false, если книги нет; бесконечный рейтинг или NaN - std::invalid_argument
+    bool Update(BookId iId, const BookUpdate &iUpdate) {
+        if (iUpdate.rating)
+            CheckRating(*iUpdate.rating);
+        const RowId row = FindRow(iId);
+        if (row == kNoRow)
+            return false;
+        const value_type before = GetBooks()[row];
+        value_type after = before;
+        after.year = iUpdate.year.value_or(before.year);
+        after.rating = iUpdate.rating.value_or(before.rating);
+        after.read_count = iUpdate.read_count.value_or(before.read_count);
+        {
+            reference ref = books_[row];
+            ref.year = after.year;
+            ref.rating = after.rating;
+            ref.read_count = after.read_count;
+        }
+        if (indexes_)
+            indexes_->Update(before, after, row);
+        if (aggregates_) {
+            aggregates_->Erase(before);
+            aggregates_->Insert(after);
+        }
+        order_indexes_.Update(before, after, row);
+        if (zone_map_)
+            zone_map_->Update(before, after, row);
+        if (compaction_.shadow && row < compaction_.cursor)
+            compaction_.shadow->Update(iId, iUpdate);
+        return true;
+    }
+
+    static constexpr size_t kCompactionStep = 64 * 1024;
+
+    // Шаг инкрементального уплотнения: до iMaxRows строк переносятся в теневую базу, живые строки
+    // копируются вместе с их BookId. Между шагами база полностью доступна: удаления и изменения
+    // уже перенесённых строк повторяются в теневой базе, новые строки перенесутся следующими шагами.
+    // На последнем шаге теневая база заменяет текущую - удалённых до начала уплотнения строк и авторов
+    // без книг больше нет (удалённые во время уплотнения остаются в маске до следующего),
+    // в арене только живые строки, номера строк (но не BookId) меняются, ссылки на книги и строки
+    // базы становятся недействительными. Возвращает итог на последнем шаге, до того - nullopt
+    std::optional<CompactionStats> CompactStep(size_t iMaxRows = kCompactionStep) {
+        if (!compaction_.shadow) {
+            compaction_.shadow = std::make_unique<BookDatabase>();
+            compaction_.cursor = 0;
+            compaction_.shadow->Reserve(GetLiveCount());
+            CopyLayoutTo(*compaction_.shadow);
+        }
+        BookDatabase &shadow = *compaction_.shadow;
+        RowId &cursor = compaction_.cursor;
+        for (const RowId last = cursor + std::min(iMaxRows, books_.size() - cursor); cursor < last; ++cursor)
+            if (!tombstones_.Test(cursor))
+                shadow.InsertWithId(GetBooks()[cursor], GetBookId(cursor));
+        if (cursor < books_.size())
+            return std::nullopt;
+
+        // Структуры, включённые за время уплотнения, строятся по уже уплотнённым строкам
+        CopyLayoutTo(shadow);
+        const CompactionStats stats{books_.size() - shadow.books_.size(), authors_.size() - shadow.authors_.size(),
+                                    strings_.GetBytesReserved(), shadow.strings_.GetBytesReserved()};
+        shadow.rows_by_id_.resize(rows_by_id_.size(), kNoRow);
+        const auto owned = std::move(compaction_.shadow);
+        *this = std::move(*owned);
+        return stats;
+    }
+
+    CompactionStats Compact() {
+        for (;;)
+            if (auto res = CompactStep(std::numeric_limits<size_t>::max()))
+                return *res;
+    }
+
+    bool IsCompacting() const noexcept { return compaction_.shadow != nullptr; }
+
+    // Неизменяемый снимок текущей версии для долгих отчётов. Книги, словарь авторов, арена строк
+    // и BookId не копируются, а разделяются со снимком: с CowBookContainer снимок стоит O(1)
+    // по книгам, с другими контейнерами книги копируются. Маска удалённых (бит на строку),
+    // агрегаты и сводки блоков копируются; вторичных индексов, индекса названий, индексов порядка
+    // и скетчей в снимке нет. Дальнейшие изменения базы снимку не видны, и его можно читать
+    // из другого потока, пока база меняется
+    std::shared_ptr<const BookDatabase> TakeSnapshot() const {
+        return std::shared_ptr<const BookDatabase>(new BookDatabase(SnapshotTag{}, *this));
+    }
+
+    // Резервирует место под iSize книг, если контейнер это умеет
+    void Reserve(size_t iSize) {
+        if constexpr (requires { books_.reserve(iSize); })
+            books_.reserve(iSize);
+    }
+
+    // Номер автора в словаре базы; новое имя копируется в арену строк базы.
+    // Книга, у которой author и author_id уже взяты из словаря этой базы, вставляется без поиска по имени
+    AuthorId InternAuthor(std::string_view iAuthor) {
+        return InternAuthor(PrehashedString{iAuthor, TransparentStringHash{}(iAuthor)});
+    }
+    AuthorId InternAuthor(const PrehashedString &iAuthor) {
+        AuthorId id = authors_.Find(iAuthor);
+        if (id == kNoAuthorId) {
+            BOOKDB_METRIC_ADD(AuthorInternMisses, 1);
+            id = authors_.Add(PrehashedString{strings_.Store(iAuthor.str), iAuthor.hash});
+        } else {
+            BOOKDB_METRIC_ADD(AuthorInternHits, 1);
+        }
+        return id;
+    }
+
     void Clear() {
         books_.clear();
         authors_.clear();
+        strings_.Clear();
+        if (indexes_)
+            indexes_->Clear();
+        if (aggregates_)
+            aggregates_->Clear();
+        if (title_index_)
+            title_index_->Clear();
+        order_indexes_.Clear();
+        if (sketches_)
+            sketches_->Clear();
+        if (zone_map_)
+            zone_map_->Clear();
+        // BookId не переиспользуются: все прежние номера просто перестают находиться
+        book_ids_.clear();
+        rows_by_id_.assign(rows_by_id_.size(), kNoRow);
+        tombstones_ = {};
+        erased_ = 0;
+        author_refs_.clear();
+        compaction_ = {};
+    }
+
+    // Переставляет книги в порядке iCmp (равные - в порядке вставки) и перестраивает всё, что
+    // ссылается на номера строк; удалённые строки при этом отбрасываются, BookId сохраняются.
+    // После кластеризации по году или жанру сводки блоков узкие, и фильтры по этим полям
+    // пропускают большинство блоков. Незавершённое уплотнение отменяется
+    template <typename Cmp>
+    void ClusterBy(const Cmp &iCmp) {
+        const std::vector<RowId> order = orderedBookIds(*this, iCmp);
+        BookContainer sorted;
+        if constexpr (requires { sorted.reserve(order.size()); })
+            sorted.reserve(order.size());
+        CowArray<BookId> ids;
+        ids.reserve(order.size());
+        for (RowId row : order) {
+            sorted.push_back(GetBooks()[row]);
+            ids.push_back(GetBookId(row));
+            rows_by_id_[ids.back()] = ids.size() - 1;
+        }
+        books_ = std::move(sorted);
+        book_ids_ = std::move(ids);
+        tombstones_ = SelectionBitmap(books_.size());
+        erased_ = 0;
+        compaction_ = {};
+
+        if (indexes_)
+            EnableIndexes();
+        if (title_index_)
+            EnableTitleIndex(title_index_->GetGramSize());
+        order_indexes_.Rebuild(books_);
+        if (zone_map_)
+            EnableZoneMap(zone_map_->GetBlockSize());
+    }
+
+    // Вторичные индексы строятся по текущему содержимому и дальше поддерживаются при вставке и Clear.
+    // Перестановка книг через неконстантные итераторы (например, std::sort) индексы не обновляет -
+    // после неё EnableIndexes нужно вызвать повторно
+    void EnableIndexes() {
+        indexes_.emplace();
+        RowId row = 0;
+        for (const auto &book : books_) {
+            if (!IsErased(row))
+                indexes_->Insert(book, row);
+            ++row;
+        }
+    }
+    void DisableIndexes() noexcept { indexes_.reset(); }
+    const SecondaryIndexes *GetIndexes() const noexcept { return indexes_ ? &*indexes_ : nullptr; }
+
+    // Агрегаты (средний рейтинг по жанрам и в целом, число книг автора, суммарный read_count)
+    // считаются по текущему содержимому и дальше обновляются при вставке, чтение - O(1).
+    // Изменение полей книг через неконстантные итераторы агрегаты не обновляет
+    void EnableAggregates() {
+        aggregates_.emplace();
+        RowId row = 0;
+        for (const auto &book : books_)
+            if (!IsErased(row++))
+                aggregates_->Insert(book);
+    }
+    void DisableAggregates() noexcept { aggregates_.reset(); }
+    const RunningAggregates *GetAggregates() const noexcept { return aggregates_ ? &*aggregates_ : nullptr; }
+
+    // Индекс n-грамм названий для searchTitles; поддерживается при вставке и Clear,
+    // после перестановки книг его нужно построить заново
+    void EnableTitleIndex(size_t iGramSize = 3) {
+        title_index_.emplace(iGramSize);
+        RowId row = 0;
+        for (const auto &book : books_) {
+            if (!IsErased(row))
+                title_index_->Insert(book.title, row);
+            ++row;
+        }
+    }
+    void DisableTitleIndex() noexcept { title_index_.reset(); }
+    const TitleIndex *GetTitleIndex() const noexcept { return title_index_ ? &*title_index_ : nullptr; }
+
+    // Приближённые скетчи (различные авторы, квантили рейтинга и года, самые читаемые авторы
+    // и названия) строятся по живым книгам и дальше обновляются при вставке. Удаления и изменения
+    // скетчи не видят, пока их не перестроит EnableSketches или уплотнение
+    void EnableSketches(const CatalogSketches::Options &iOpt = {}) {
+        if (!erased_) {
+            sketches_ = buildCatalogSketches(books_, iOpt);
+            return;
+        }
+        sketches_.emplace(iOpt);
+        RowId row = 0;
+        for (const auto &book : books_)
+            if (!IsErased(row++))
+                sketches_->Insert(book);
+    }
+    void DisableSketches() noexcept { sketches_.reset(); }
+    // Оценки скетчей включают книги, удалённые или изменённые после их построения
+    const CatalogSketches *GetSketches() const noexcept { return sketches_ ? &*sketches_ : nullptr; }
+
+    // Сводки по блокам из iBlockSize строк (границы года, рейтинга и read_count, маска жанров)
+    // для пропуска блоков в selectBooks, filterBookIds и агрегатах с предикатом.
+    // Поддерживаются при вставке и Clear, ClusterBy перестраивает их сам
+    void EnableZoneMap(size_t iBlockSize = ZoneMap::kDefaultBlockSize) {
+        zone_map_.emplace(books_, iBlockSize);
+        tombstones_.ForEachSet([this](RowId row) { zone_map_->Erase(value_type(GetBooks()[row]), row); });
+    }
+    void DisableZoneMap() noexcept { zone_map_.reset(); }
+    const ZoneMap *GetZoneMap() const noexcept { return zone_map_ ? &*zone_map_ : nullptr; }
+
+    // Индекс порядка для компаратора Cmp (например, comp::GreaterByRating): упорядоченный обход
+    // и диапазоны без сортировки и перестановки книг. Поддерживается при вставке, удалении,
+    // изменении и Clear, удалённых строк в нём нет. После перестановки книг его нужно построить заново
+    template <OrderIndexable Cmp>
+    void EnableOrderIndex() {
+        order_indexes_.Enable<Cmp>(books_, [this](RowId iRow) { return IsErased(iRow); });
+    }
+    template <OrderIndexable Cmp>
+    void DisableOrderIndex() noexcept {
+        order_indexes_.Disable<Cmp>();
+    }
+    template <OrderIndexable Cmp>
+    const OrderIndex<Cmp> *GetOrderIndex() const noexcept {
+        return order_indexes_.Get<Cmp>();
     }
 
 private:
-    constexpr bool RegAuthor(value_type &iRef) {
-        auto [it, trig] = authors_.emplace(iRef.author);
-        iRef.author = *it;
-        return trig;
+    struct SnapshotTag {};
+
+    // NaN и бесконечности ломают порядок в индексах, сводках блоков и компараторах рейтинга
+    static constexpr void CheckRating(double iRating) {
+        if (!std::isfinite(iRating))
+            throw std::invalid_argument{"Book rating must be finite"};
+    }
+
+    BookDatabase(SnapshotTag, const BookDatabase &iOther)
+        : books_(iOther.books_), authors_(iOther.authors_), strings_(iOther.strings_),
+          aggregates_(iOther.aggregates_), zone_map_(iOther.zone_map_), book_ids_(iOther.book_ids_),
+          rows_by_id_(iOther.rows_by_id_), tombstones_(iOther.tombstones_), erased_(iOther.erased_),
+          author_refs_(iOther.author_refs_) {}
+
+    constexpr void OnInsert(reference iRef, BookId iId = kNoBookId) {
+        iRef.title = strings_.Store(iRef.title);
+        RegAuthor(iRef);
+        UpdateDerived(iRef, iId);
+    }
+
+    // Вставка с уже назначенным BookId - перенос строки при уплотнении
+    void InsertWithId(const value_type &iBook, BookId iId) {
+        books_.push_back(iBook);
+        OnInsert(books_.back(), iId);
+    }
+
+    // Обновление номеров, индексов, агрегатов и скетчей для последней вставленной книги.
+    // kNoBookId - назначить следующий свободный BookId
+    constexpr void UpdateDerived(reference iRef, BookId iId = kNoBookId) {
+        BOOKDB_METRIC_ADD(Inserts, 1);
+        TrackRow(books_.size() - 1, iId, iRef.author_id);
+        if (indexes_)
+            indexes_->Insert(iRef, books_.size() - 1);
+        if (aggregates_)
+            aggregates_->Insert(iRef);
+        if (title_index_)
+            title_index_->Insert(iRef.title, books_.size() - 1);
+        order_indexes_.Insert(iRef, books_.size() - 1);
+        if (sketches_)
+            sketches_->Insert(iRef);
+        if (zone_map_)
+            zone_map_->Insert(iRef, books_.size() - 1);
+    }
+
+    void TrackRow(RowId iRow, BookId iId, AuthorId iAuthor) {
+        if (iId == kNoBookId)
+            iId = rows_by_id_.size();
+        if (iId >= rows_by_id_.size())
+            rows_by_id_.resize(iId + 1, kNoRow);
+        rows_by_id_[iId] = iRow;
+        book_ids_.push_back(iId);
+        tombstones_.Resize(books_.size());
+        if (iAuthor >= author_refs_.size())
+            author_refs_.resize(iAuthor + 1);
+        ++author_refs_[iAuthor];
+    }
+
+    // Включает в oTarget те же необязательные структуры с теми же параметрами и выключает остальные
+    void CopyLayoutTo(BookDatabase &oTarget) const {
+        if (!indexes_)
+            oTarget.DisableIndexes();
+        else if (!oTarget.indexes_)
+            oTarget.EnableIndexes();
+        if (!aggregates_)
+            oTarget.DisableAggregates();
+        else if (!oTarget.aggregates_)
+            oTarget.EnableAggregates();
+        if (!title_index_)
+            oTarget.DisableTitleIndex();
+        else if (!oTarget.title_index_ || oTarget.title_index_->GetGramSize() != title_index_->GetGramSize())
+            oTarget.EnableTitleIndex(title_index_->GetGramSize());
+        if (!sketches_)
+            oTarget.DisableSketches();
+        else if (!oTarget.sketches_)
+            oTarget.EnableSketches(sketches_->GetOptions());
+        if (!zone_map_)
+            oTarget.DisableZoneMap();
+        else if (!oTarget.zone_map_ || oTarget.zone_map_->GetBlockSize() != zone_map_->GetBlockSize())
+            oTarget.EnableZoneMap(zone_map_->GetBlockSize());
+        oTarget.order_indexes_.MatchLayout(order_indexes_, oTarget.books_,
+                                           [&oTarget](RowId iRow) { return oTarget.IsErased(iRow); });
+    }
+
+    constexpr bool RegAuthor(reference iRef) {
+        if (IsInterned(iRef.author, iRef.author_id)) {
+            BOOKDB_METRIC_ADD(AuthorInternHits, 1);
+            return false;
+        }
+        const size_t before = authors_.size();
+        const AuthorId id = InternAuthor(iRef.author);
+        iRef.author = authors_.GetName(id);
+        iRef.author_id = id;
+        return authors_.size() != before;
+    }
+
+    bool IsInterned(std::string_view iAuthor, AuthorId iId) const noexcept {
+        if (iId >= authors_.size())
+            return false;
+        const std::string_view name = authors_.GetName(iId);
+        return name.data() == iAuthor.data() && name.size() == iAuthor.size();
     }
 
     BookContainer books_;
     AuthorContainer authors_;
+    StringArena strings_;
+    std::optional<SecondaryIndexes> indexes_;
+    std::optional<RunningAggregates> aggregates_;
+    std::optional<TitleIndex> title_index_;
+    OrderIndexes order_indexes_;
+    std::optional<CatalogSketches> sketches_;
+    std::optional<ZoneMap> zone_map_;
+    // book_ids_[row] - BookId строки, rows_by_id_[id] - строка книги или kNoRow
+    CowArray<BookId> book_ids_;
+    CowArray<RowId> rows_by_id_;
+    SelectionBitmap tombstones_;
+    size_t erased_ = 0;
+    std::vector<size_t> author_refs_;
+    details::CompactionSlot<BookDatabase> compaction_;
 };  // end class BookDatabase
 }  // namespace bookdb
 
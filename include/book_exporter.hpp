@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <concepts>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "thread_pool.hpp"
+
+// Выгрузка базы в CSV или JSON Lines. Строки сериализуются кусками параллельно в буферы,
+// которые переиспользуются от волны к волне, и отдаются приёмнику в порядке строк базы.
+// Числа пишутся через std::to_chars, жанры - из таблицы имён, поэтому на строку
+// не выделяется память. CSV читается обратно loadBooks с теми же delimiter и has_header.
+// Бесконечный рейтинг или NaN выгружается как отсутствующее значение в обоих форматах:
+// пустое поле CSV (loadBooks такую строку отвергает) и null в JSON
+namespace bookdb {
+
+enum class ExportFormat { Csv, JsonLines };
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::Csv;
+    char delimiter = ',';        // только для CSV
+    bool header = true;          // строка заголовка CSV
+    size_t chunk_rows = 16'384;  // строк в одном куске сериализации
+    Parallelism par{};
+};
+
+struct ExportReport {
+    size_t rows_written = 0;
+    size_t bytes_written = 0;
+    std::chrono::duration<double> elapsed{};
+
+    double RowsPerSecond() const noexcept { return elapsed.count() > 0. ? rows_written / elapsed.count() : 0.; }
+};
+
+namespace details {
+template <typename N>
+void AppendNumber(std::string &oBuf, N iValue) {
+    std::array<char, 32> tmp;
+    const auto [end, ec] = std::to_chars(tmp.data(), tmp.data() + tmp.size(), iValue);
+    oBuf.append(tmp.data(), end);
+}
+
+// Поле с разделителем, кавычкой или переводом строки берётся в кавычки, кавычки внутри удваиваются
+inline void AppendCsvField(std::string &oBuf, std::string_view iField, char iDelimiter) {
+    const char special[] = {iDelimiter, '"', '\n', '\r'};
+    if (iField.find_first_of(std::string_view(special, std::size(special))) == std::string_view::npos) {
+        oBuf.append(iField);
+        return;
+    }
+    oBuf += '"';
+    for (char c : iField) {
+        if (c == '"')
+            oBuf += '"';
+        oBuf += c;
+    }
+    oBuf += '"';
+}
+
+inline void AppendJsonString(std::string &oBuf, std::string_view iStr) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    oBuf += '"';
+    size_t plain = 0;
+    for (size_t i = 0; i < iStr.size(); ++i) {
+        const auto c = static_cast<unsigned char>(iStr[i]);
+        if (c >= 0x20 && c != '"' && c != '\\')
+            continue;
+        oBuf.append(iStr.substr(plain, i - plain));
+        plain = i + 1;
+        switch (c) {
+        case '"':
+            oBuf += "\\\"";
+            break;
+        case '\\':
+            oBuf += "\\\\";
+            break;
+        case '\n':
+            oBuf += "\\n";
+            break;
+        case '\r':
+            oBuf += "\\r";
+            break;
+        case '\t':
+            oBuf += "\\t";
+            break;
+        default:
+            oBuf += "\\u00";
+            oBuf += kHex[c >> 4];
+            oBuf += kHex[c & 0xf];
+        }
+    }
+    oBuf.append(iStr.substr(plain));
+    oBuf += '"';
+}
+
+template <typename B>
+void AppendCsvRow(std::string &oBuf, const B &iBook, char iDelimiter) {
+    AppendCsvField(oBuf, iBook.title, iDelimiter);
+    oBuf += iDelimiter;
+    AppendCsvField(oBuf, iBook.author, iDelimiter);
+    oBuf += iDelimiter;
+    AppendNumber(oBuf, iBook.year);
+    oBuf += iDelimiter;
+    oBuf.append(GenreName(iBook.genre));
+    oBuf += iDelimiter;
+    if (std::isfinite(iBook.rating))
+        AppendNumber(oBuf, iBook.rating);
+    oBuf += iDelimiter;
+    AppendNumber(oBuf, iBook.read_count);
+    oBuf += '\n';
+}
+
+template <typename B>
+void AppendJsonRow(std::string &oBuf, const B &iBook) {
+    oBuf += "{\"title\":";
+    AppendJsonString(oBuf, iBook.title);
+    oBuf += ",\"author\":";
+    AppendJsonString(oBuf, iBook.author);
+    oBuf += ",\"year\":";
+    AppendNumber(oBuf, iBook.year);
+    oBuf += ",\"genre\":\"";
+    oBuf.append(GenreName(iBook.genre));
+    oBuf += "\",\"rating\":";
+    if (std::isfinite(iBook.rating))
+        AppendNumber(oBuf, iBook.rating);
+    else
+        oBuf += "null";
+    oBuf += ",\"read_count\":";
+    AppendNumber(oBuf, iBook.read_count);
+    oBuf += "}\n";
+}
+}  // namespace details
+
+// iSink(std::string_view) получает текст кусками по порядку строк базы; куски действительны
+// только до возврата из iSink. Удалённые строки не выгружаются
+template <BookContainerLike T, std::invocable<std::string_view> Sink>
+ExportReport exportBooks(const BookDatabase<T> &iDb, Sink &&iSink, const ExportOptions &iOpt = {}) {
+    const auto start = std::chrono::steady_clock::now();
+    const bool csv = iOpt.format == ExportFormat::Csv;
+    const auto &books = iDb.GetBooks();
+    ExportReport report;
+
+    std::string header;
+    if (csv && iOpt.header) {
+        for (std::string_view name : {"title", "author", "year", "genre", "rating", "read_count"}) {
+            header.append(name);
+            header += iOpt.delimiter;
+        }
+        header.back() = '\n';
+        iSink(std::string_view(header));
+        report.bytes_written += header.size();
+    }
+
+    // Волна - по куску на каждую часть; буферы частей живут всю выгрузку
+    const size_t chunkRows = std::max<size_t>(1, iOpt.chunk_rows);
+    std::vector<std::string> buffers(ParallelPartCount(books.size(), iOpt.par));
+    std::vector<size_t> rows(buffers.size());
+    for (size_t waveBegin = 0; waveBegin < books.size();) {
+        const size_t waveSize = std::min(books.size() - waveBegin, buffers.size() * chunkRows);
+        ParallelFor(waveSize, iOpt.par, [&](size_t part, size_t begin, size_t end) {
+            std::string &buf = buffers[part];
+            buf.clear();
+            rows[part] = 0;
+            for (RowId row = waveBegin + begin; row < waveBegin + end; ++row) {
+                if (iDb.IsErased(row))
+                    continue;
+                if (csv)
+                    details::AppendCsvRow(buf, books[row], iOpt.delimiter);
+                else
+                    details::AppendJsonRow(buf, books[row]);
+                ++rows[part];
+            }
+        });
+        for (size_t part = 0; part < ParallelPartCount(waveSize, iOpt.par); ++part) {
+            iSink(std::string_view(buffers[part]));
+            report.bytes_written += buffers[part].size();
+            report.rows_written += rows[part];
+        }
+        waveBegin += waveSize;
+    }
+
+    report.elapsed = std::chrono::steady_clock::now() - start;
+    return report;
+}
+
+template <BookContainerLike T>
+ExportReport exportBooks(const BookDatabase<T> &iDb, std::ostream &oOut, const ExportOptions &iOpt = {}) {
+    ExportReport report = exportBooks(
+        iDb, [&oOut](std::string_view iText) { oOut.write(iText.data(), static_cast<std::streamsize>(iText.size())); },
+        iOpt);
+    if (!oOut)
+        throw std::runtime_error{"Export write failed"};
+    return report;
+}
+
+// Файл пишется во временный рядом и переименовывается, как снимок в saveSnapshot;
+// при ошибке временный файл удаляется
+template <BookContainerLike T>
+ExportReport exportBooksToFile(const BookDatabase<T> &iDb, const std::filesystem::path &iPath,
+                               const ExportOptions &iOpt = {}) {
+    auto tmpPath = iPath;
+    tmpPath += ".tmp";
+    ExportReport report;
+    try {
+        {
+            std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+            if (!out)
+                throw std::runtime_error{"Cannot create " + tmpPath.string()};
+            report = exportBooks(iDb, out, iOpt);
+            out.flush();
+            if (!out)
+                throw std::runtime_error{"Export write failed"};
+        }
+        std::filesystem::rename(tmpPath, iPath);
+    } catch (...) {
+        std::error_code ec;
+        std::filesystem::remove(tmpPath, ec);
+        throw;
+    }
+    return report;
+}
+}  // namespace bookdb
@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "book_database.hpp"
+#include "heterogeneous_lookup.hpp"
+#include "mapped_file.hpp"
+#include "string_arena.hpp"
+#include "thread_pool.hpp"
+
+// Массовая загрузка книг из CSV/TSV. Файл отображается в память, делится на части
+// по границам строк, части разбираются параллельно. Поля книг - string_view прямо в
+// отображение, копируются только поля в кавычках с экранированием. Порядок колонок -
+// как в конструкторе Book: title, author, year, genre, rating, read_count.
+// Одна запись - одна строка файла
+namespace bookdb {
+
+struct LoadOptions {
+    char delimiter = ',';     // '\t' для TSV
+    bool has_header = true;   // первая строка файла - заголовок
+    size_t max_errors = 100;  // сколько ошибок сохранить в отчёте, остальные только считаются
+    Parallelism par{};
+};
+
+struct LoadError {
+    size_t line;         // номер строки файла, с единицы
+    const char *reason;  // статическая строка
+};
+
+struct LoadReport {
+    size_t rows_loaded = 0;
+    size_t rows_rejected = 0;
+    std::vector<LoadError> errors;
+    std::chrono::duration<double> elapsed{};
+
+    double RowsPerSecond() const noexcept { return elapsed.count() > 0. ? rows_loaded / elapsed.count() : 0.; }
+};
+
+namespace details {
+// Начало первой строки, которая начинается не раньше iPos. Соседние части вычисляют
+// свои границы одной и той же функцией, поэтому каждая строка достаётся ровно одной части
+inline size_t AlignToLine(std::string_view iText, size_t iPos) noexcept {
+    if (iPos == 0 || iPos >= iText.size())
+        return std::min(iPos, iText.size());
+    const size_t nl = iText.find('\n', iPos - 1);
+    return nl == std::string_view::npos ? iText.size() : nl + 1;
+}
+
+// Разбор полей одной строки. Ошибка - статическая строка с причиной
+class LineParser {
+public:
+    LineParser(std::string_view iLine, char iDelimiter, StringArena &ioScratch)
+        : line_(iLine), delimiter_(iDelimiter), scratch_(ioScratch) {}
+
+    const char *Next(std::string_view &oField) {
+        if (done_)
+            return "too few fields";
+        if (pos_ < line_.size() && line_[pos_] == '"')
+            return NextQuoted(oField);
+        const size_t end = std::min(line_.find(delimiter_, pos_), line_.size());
+        oField = line_.substr(pos_, end - pos_);
+        Advance(end);
+        return nullptr;
+    }
+
+    bool AtEnd() const noexcept { return done_; }
+
+private:
+    // Поле в кавычках: "" внутри - экранированная кавычка. Без экранирования
+    // поле остаётся видом в исходный текст, иначе раскрывается во временную арену части
+    const char *NextQuoted(std::string_view &oField) {
+        size_t pos = pos_ + 1;
+        bool escaped = false;
+        while (true) {
+            const size_t quote = line_.find('"', pos);
+            if (quote == std::string_view::npos)
+                return "unterminated quoted field";
+            if (quote + 1 < line_.size() && line_[quote + 1] == '"') {
+                escaped = true;
+                pos = quote + 2;
+                continue;
+            }
+            if (quote + 1 < line_.size() && line_[quote + 1] != delimiter_)
+                return "garbage after closing quote";
+            oField = line_.substr(pos_ + 1, quote - pos_ - 1);
+            if (escaped)
+                oField = Unescape(oField);
+            Advance(quote + 1);
+            return nullptr;
+        }
+    }
+
+    std::string_view Unescape(std::string_view iField) {
+        buffer_.clear();
+        for (size_t i = 0; i < iField.size(); ++i) {
+            buffer_.push_back(iField[i]);
+            if (iField[i] == '"')
+                ++i;
+        }
+        return scratch_.Store({buffer_.data(), buffer_.size()});
+    }
+
+    void Advance(size_t iEnd) noexcept {
+        pos_ = iEnd + 1;
+        done_ = iEnd >= line_.size();
+    }
+
+    std::string_view line_;
+    char delimiter_;
+    StringArena &scratch_;
+    std::vector<char> buffer_;
+    size_t pos_ = 0;
+    bool done_ = false;
+};
+
+// from_chars принимает nan и inf; такие числа ломают порядок в индексах и компараторах и отвергаются
+template <typename T>
+bool ParseNumber(std::string_view iField, T &oValue) noexcept {
+    const auto [ptr, ec] = std::from_chars(iField.data(), iField.data() + iField.size(), oValue);
+    if (ec != std::errc{} || ptr != iField.data() + iField.size())
+        return false;
+    if constexpr (std::is_floating_point_v<T>)
+        return std::isfinite(oValue);
+    return true;
+}
+
+inline const char *ParseBookLine(std::string_view iLine, char iDelimiter, StringArena &ioScratch,
+                                 std::optional<Book> &oBook) {
+    LineParser parser(iLine, iDelimiter, ioScratch);
+    std::string_view title, author, year, genre, rating, readCount;
+    for (std::string_view *field : {&title, &author, &year, &genre, &rating, &readCount})
+        if (const char *err = parser.Next(*field))
+            return err;
+    if (!parser.AtEnd())
+        return "too many fields";
+
+    int y = 0, rc = 0;
+    double r = 0.;
+    if (!ParseNumber(year, y))
+        return "bad year";
+    if (!ParseNumber(rating, r))
+        return "bad rating";
+    if (!ParseNumber(readCount, rc))
+        return "bad read_count";
+    oBook.emplace(title, author, y, GenreFromString(genre), r, rc);
+    return nullptr;
+}
+
+// Результат разбора одной части: книги с локальными номерами авторов и локальный словарь
+struct LoadChunk {
+    std::vector<Book> books;
+    std::vector<std::string_view> authors;
+    std::vector<LoadError> errors;
+    size_t rejected = 0;
+    size_t lines = 0;
+    StringArena scratch{4096};
+};
+
+// Строки нумеруются с единицы внутри части, глобальные номера восстанавливаются при слиянии
+inline void ParseChunk(std::string_view iText, bool iSkipHeader, const LoadOptions &iOpt, LoadChunk &oChunk) {
+    std::unordered_map<std::string_view, AuthorId, TransparentStringHash, TransparentStringEqual> localAuthors;
+    std::optional<Book> book;
+    size_t pos = 0;
+    while (pos < iText.size()) {
+        size_t end = iText.find('\n', pos);
+        if (end == std::string_view::npos)
+            end = iText.size();
+        std::string_view line = iText.substr(pos, end - pos);
+        pos = end + 1;
+        const size_t lineNo = ++oChunk.lines;
+
+        if (!line.empty() && line.back() == '\r')
+            line.remove_suffix(1);
+        if (line.empty() || (lineNo == 1 && iSkipHeader))
+            continue;
+
+        if (const char *err = ParseBookLine(line, iOpt.delimiter, oChunk.scratch, book)) {
+            ++oChunk.rejected;
+            if (oChunk.errors.size() < iOpt.max_errors)
+                oChunk.errors.push_back({lineNo, err});
+            continue;
+        }
+        // Авторы интернируются пакетно: внутри части - здесь, в словарь базы - один раз на имя при слиянии
+        auto [it, inserted] = localAuthors.try_emplace(book->author, static_cast<AuthorId>(oChunk.authors.size()));
+        if (inserted)
+            oChunk.authors.push_back(book->author);
+        book->author_id = it->second;
+        oChunk.books.push_back(*book);
+    }
+}
+}  // namespace details
+
+// Разбор текста, уже находящегося в памяти. Некорректные строки пропускаются и попадают в отчёт
+template <BookContainerLike T>
+LoadReport loadBooks(BookDatabase<T> &ioDb, std::string_view iText, const LoadOptions &iOpt = {}) {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<details::LoadChunk> chunks(ParallelPartCount(iText.size(), iOpt.par));
+    ParallelFor(iText.size(), iOpt.par, [&](size_t part, size_t begin, size_t end) {
+        begin = details::AlignToLine(iText, begin);
+        end = details::AlignToLine(iText, end);
+        details::ParseChunk(iText.substr(begin, end - begin), part == 0 && iOpt.has_header, iOpt, chunks[part]);
+    });
+
+    LoadReport report;
+    size_t total = 0;
+    for (const auto &chunk : chunks)
+        total += chunk.books.size();
+    ioDb.Reserve(ioDb.size() + total);
+
+    size_t linesBefore = 0;
+    std::vector<AuthorId> remap;
+    for (auto &chunk : chunks) {
+        remap.resize(chunk.authors.size());
+        std::transform(chunk.authors.begin(), chunk.authors.end(), remap.begin(),
+                       [&ioDb](std::string_view author) { return ioDb.InternAuthor(author); });
+        for (Book &book : chunk.books) {
+            book.author_id = remap[book.author_id];
+            book.author = ioDb.GetAuthors().GetName(book.author_id);
+        }
+        ioDb.BulkInsert(chunk.books);
+
+        for (const auto &error : chunk.errors)
+            if (report.errors.size() < iOpt.max_errors)
+                report.errors.push_back({linesBefore + error.line, error.reason});
+        linesBefore += chunk.lines;
+        report.rows_loaded += chunk.books.size();
+        report.rows_rejected += chunk.rejected;
+    }
+
+    report.elapsed = std::chrono::steady_clock::now() - start;
+    return report;
+}
+
+template <BookContainerLike T>
+LoadReport loadBooksFromFile(BookDatabase<T> &ioDb, const std::filesystem::path &iPath, const LoadOptions &iOpt = {}) {
+    const auto start = std::chrono::steady_clock::now();
+    const MappedFile file(iPath);
+    file.AdviseSequential();
+    LoadReport report = loadBooks(ioDb, file.GetData(), iOpt);
+    // В отчёт входит и отображение файла
+    report.elapsed = std::chrono::steady_clock::now() - start;
+    return report;
+}
+}  // namespace bookdb
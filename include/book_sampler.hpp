@@ -0,0 +1,280 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "concepts.hpp"
+
+namespace bookdb {
+namespace details {
+// Таблица псевдонимов (метод Воуза): выбор индекса с вероятностью, пропорциональной весу, за O(1).
+// Каждая ячейка хранит порог и запасной индекс: бросаем равномерную ячейку, затем монету
+class AliasTable {
+public:
+    AliasTable() = default;
+
+    explicit AliasTable(std::span<const double> iWeights) {
+        double total = 0.;
+        for (double w : iWeights)
+            total += w;
+        if (iWeights.empty() || !(total > 0.))
+            return;
+
+        const size_t n = iWeights.size();
+        threshold_.resize(n);
+        alias_.resize(n);
+        std::vector<double> scaled(n);
+        std::vector<size_t> small, large;
+        for (size_t i = 0; i < n; ++i) {
+            scaled[i] = iWeights[i] * static_cast<double>(n) / total;
+            (scaled[i] < 1. ? small : large).push_back(i);
+        }
+        while (!small.empty() && !large.empty()) {
+            const size_t s = small.back(), l = large.back();
+            small.pop_back();
+            threshold_[s] = scaled[s];
+            alias_[s] = l;
+            scaled[l] -= 1. - scaled[s];
+            if (scaled[l] < 1.) {
+                large.pop_back();
+                small.push_back(l);
+            }
+        }
+        // Остатки из-за округления - полные ячейки
+        for (const auto *rest : {&large, &small})
+            for (size_t i : *rest) {
+                threshold_[i] = 1.;
+                alias_[i] = i;
+            }
+    }
+
+    bool empty() const noexcept { return threshold_.empty(); }
+
+    template <std::uniform_random_bit_generator G>
+    size_t operator()(G &ioGen) const {
+        const size_t cell = std::uniform_int_distribution<size_t>(0, threshold_.size() - 1)(ioGen);
+        return std::uniform_real_distribution<double>(0., 1.)(ioGen) < threshold_[cell] ? cell : alias_[cell];
+    }
+
+private:
+    std::vector<double> threshold_;
+    std::vector<size_t> alias_;
+};
+
+// Дерево Фенвика над весами: изменение веса и выбор по накопленной сумме за O(log N)
+class FenwickTree {
+public:
+    // Прежние значения изменённых узлов для точного отката
+    using Journal = std::vector<std::pair<size_t, double>>;
+
+    FenwickTree() = default;
+
+    explicit FenwickTree(std::span<const double> iWeights) : tree_(iWeights.begin(), iWeights.end()) {
+        for (size_t i = 0; i < tree_.size(); ++i)
+            if (size_t parent = i | (i + 1); parent < tree_.size())
+                tree_[parent] += tree_[i];
+    }
+
+    void Add(size_t iPos, double iDelta) noexcept {
+        for (; iPos < tree_.size(); iPos |= iPos + 1)
+            tree_[iPos] += iDelta;
+    }
+
+    // Изменение с записью в журнал: Restore возвращает узлам ровно прежние значения,
+    // без погрешности обратного прибавления
+    void Add(size_t iPos, double iDelta, Journal &ioJournal) {
+        for (; iPos < tree_.size(); iPos |= iPos + 1) {
+            ioJournal.emplace_back(iPos, tree_[iPos]);
+            tree_[iPos] += iDelta;
+        }
+    }
+
+    void Restore(Journal &ioJournal) noexcept {
+        for (auto it = ioJournal.rbegin(); it != ioJournal.rend(); ++it)
+            tree_[it->first] = it->second;
+        ioJournal.clear();
+    }
+
+    double Total() const noexcept {
+        double res = 0.;
+        for (size_t end = tree_.size(); end > 0; end &= end - 1)
+            res += tree_[end - 1];
+        return res;
+    }
+
+    // Первая позиция, на которой накопленная сумма превышает iTarget
+    size_t Find(double iTarget) const noexcept {
+        size_t pos = 0;
+        for (size_t step = std::bit_floor(tree_.size()); step > 0; step /= 2)
+            if (pos + step <= tree_.size() && tree_[pos + step - 1] <= iTarget) {
+                pos += step;
+                iTarget -= tree_[pos - 1];
+            }
+        return std::min(pos, tree_.size() - 1);
+    }
+
+private:
+    std::vector<double> tree_;
+};
+}  // namespace details
+
+enum class SampleWeight { Uniform, ReadCount, Rating };
+
+// Сэмплер книг базы: таблицы псевдонимов строятся один раз за O(N), после чего каждая выборка
+// с возвращением стоит O(1), а без возвращения - O(log N). Отдельные таблицы по жанрам дают
+// стратифицированные выборки. Удалённые строки получают нулевой вес.
+// Сэмплер запоминает номера строк на момент построения;
+// генератор передаётся снаружи, поэтому один seed воспроизводит ту же последовательность
+class BookSampler {
+public:
+    template <BookContainerLike T>
+    explicit BookSampler(const BookDatabase<T> &iDb, SampleWeight iWeight = SampleWeight::Uniform) {
+        weights_.reserve(iDb.size());
+        std::array<std::vector<double>, kGenreCount> genreWeights;
+        RowId row = 0;
+        for (const auto &book : iDb) {
+            const double w = iDb.IsErased(row) ? 0. : WeightOf(book, iWeight);
+            const size_t slot = details::GenreSlot(book.genre);
+            weights_.push_back(w);
+            positive_ += w > 0.;
+            genre_rows_[slot].push_back(row++);
+            genreWeights[slot].push_back(w);
+            genre_totals_[slot] += w;
+        }
+        table_ = details::AliasTable(weights_);
+        for (size_t slot = 0; slot < kGenreCount; ++slot)
+            genre_tables_[slot] = details::AliasTable(genreWeights[slot]);
+    }
+
+    size_t size() const noexcept { return weights_.size(); }
+
+    // Одна книга с возвращением, O(1)
+    template <std::uniform_random_bit_generator G>
+    RowId Draw(G &ioGen) const {
+        if (table_.empty())
+            throw std::runtime_error{"No books with positive weight to sample"};
+        return table_(ioGen);
+    }
+
+    template <std::uniform_random_bit_generator G>
+    RowId Draw(Genre iGenre, G &ioGen) const {
+        const size_t slot = details::GenreSlot(iGenre);
+        if (genre_tables_[slot].empty())
+            throw std::runtime_error{"No books with positive weight to sample in genre"};
+        return genre_rows_[slot][genre_tables_[slot](ioGen)];
+    }
+
+    template <std::uniform_random_bit_generator G>
+    std::vector<RowId> Sample(size_t iCount, G &ioGen) const {
+        std::vector<RowId> res(iCount);
+        for (RowId &row : res)
+            row = Draw(ioGen);
+        return res;
+    }
+
+    // iPerGenre[slot] книг из каждого жанра, с возвращением
+    template <std::uniform_random_bit_generator G>
+    std::vector<RowId> SampleStratified(const std::array<size_t, kGenreCount> &iPerGenre, G &ioGen) const {
+        std::vector<RowId> res;
+        for (size_t slot = 0; slot < kGenreCount; ++slot)
+            for (size_t i = 0; i < iPerGenre[slot]; ++i)
+                res.push_back(Draw(static_cast<Genre>(slot), ioGen));
+        return res;
+    }
+
+    // iCount книг, разделённых между жанрами пропорционально их суммарному весу
+    // (метод наибольших остатков), так что доля каждого жанра в выборке не случайна
+    template <std::uniform_random_bit_generator G>
+    std::vector<RowId> SampleStratified(size_t iCount, G &ioGen) const {
+        return SampleStratified(AllocateStrata(iCount), ioGen);
+    }
+
+    // iCount различных книг с вероятностями, пропорциональными весам, O(iCount log N).
+    // Изменяет внутреннее дерево весов и по журналу точно восстанавливает его, поэтому не const
+    template <std::uniform_random_bit_generator G>
+    std::vector<RowId> SampleDistinct(size_t iCount, G &ioGen) {
+        if (iCount > positive_)
+            throw std::runtime_error{"Not enough books with positive weight to sample"};
+        if (!fenwick_)
+            fenwick_ = details::FenwickTree(weights_);
+
+        std::vector<RowId> res;
+        std::unordered_set<RowId> taken;
+        res.reserve(iCount);
+        details::FenwickTree::Journal journal;
+        try {
+            for (size_t i = 0; i < iCount; ++i) {
+                RowId row;
+                // Погрешность вычитания может указать на выбранную строку или строку с нулевым весом -
+                // тогда бросаем заново, а не берём соседнюю, чтобы не смещать вероятности
+                do
+                    row = fenwick_->Find(std::uniform_real_distribution<double>(0., fenwick_->Total())(ioGen));
+                while (weights_[row] <= 0. || taken.contains(row));
+                fenwick_->Add(row, -weights_[row], journal);
+                taken.insert(row);
+                res.push_back(row);
+            }
+        } catch (...) {
+            fenwick_->Restore(journal);
+            throw;
+        }
+        fenwick_->Restore(journal);
+        return res;
+    }
+
+private:
+    static double WeightOf(const auto &iBook, SampleWeight iWeight) noexcept {
+        switch (iWeight) {
+        case SampleWeight::ReadCount:
+            return std::max(0., static_cast<double>(iBook.read_count));
+        case SampleWeight::Rating:
+            return std::max(0., static_cast<double>(iBook.rating));
+        default:
+            return 1.;
+        }
+    }
+
+    std::array<size_t, kGenreCount> AllocateStrata(size_t iCount) const {
+        double total = 0.;
+        for (double w : genre_totals_)
+            total += w;
+        std::array<size_t, kGenreCount> res{};
+        if (!(total > 0.))
+            return res;
+
+        std::array<double, kGenreCount> remainders{};
+        size_t allocated = 0;
+        for (size_t slot = 0; slot < kGenreCount; ++slot) {
+            const double exact = static_cast<double>(iCount) * genre_totals_[slot] / total;
+            res[slot] = static_cast<size_t>(exact);
+            remainders[slot] = genre_totals_[slot] > 0. ? exact - static_cast<double>(res[slot]) : -1.;
+            allocated += res[slot];
+        }
+        for (; allocated < iCount; ++allocated) {
+            const size_t slot = std::ranges::max_element(remainders) - remainders.begin();
+            ++res[slot];
+            remainders[slot] = 0.;
+        }
+        return res;
+    }
+
+    std::vector<double> weights_;
+    size_t positive_ = 0;
+    details::AliasTable table_;
+    std::array<std::vector<RowId>, kGenreCount> genre_rows_;
+    std::array<details::AliasTable, kGenreCount> genre_tables_;
+    std::array<double, kGenreCount> genre_totals_{};
+    std::optional<details::FenwickTree> fenwick_;
+};
+}  // namespace bookdb
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+#include <string>
+#include <vector>
+
+#include "book.hpp"
+#include "book_database.hpp"
+#include "split_mix64.hpp"
+
+// Детерминированный генератор синтетических каталогов для бенчмарков и тестов.
+// Стандартные распределения <random> зависят от реализации библиотеки, поэтому
+// генератор и преобразования написаны здесь: один и тот же seed даёт один и тот же
+// каталог на любой платформе, и результаты бенчмарков разных релизов сравнимы
+namespace bookdb {
+
+struct CatalogOptions {
+    size_t rows = 1000;
+    size_t authors = 100;
+    double author_skew = 1.;  // показатель Ципфа для популярности авторов, 0 - равномерно
+    // Относительные веса жанров в порядке перечисления Genre
+    std::array<double, kGenreCount> genre_weights{4., 2., 2., 1., 2., 0.5};
+    double rating_mean = 3.8;  // рейтинги - нормальное распределение, обрезанное до [0, 5]
+    double rating_stddev = 0.6;
+    int first_year = 1800;
+    int last_year = 2025;
+    uint64_t seed = 42;
+};
+
+namespace details {
+// Выбор по накопленным весам двоичным поиском
+class CumulativeChoice {
+public:
+    template <typename Weights>
+    explicit CumulativeChoice(const Weights &iWeights) {
+        cdf_.reserve(std::size(iWeights));
+        double sum = 0.;
+        for (double w : iWeights)
+            cdf_.push_back(sum += std::max(w, 0.));
+        if (sum <= 0.)
+            std::fill(cdf_.begin(), cdf_.end(), 1.);
+    }
+
+    size_t operator()(SplitMix64 &ioRng) const noexcept {
+        const double u = ioRng.NextDouble() * cdf_.back();
+        const auto it = std::upper_bound(cdf_.begin(), cdf_.end(), u);
+        return std::min(static_cast<size_t>(it - cdf_.begin()), cdf_.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+}  // namespace details
+
+// Вызывает iFunc(const Book &) для каждой книги каталога. Строки книги действительны только
+// во время вызова - BookDatabase копирует их в свою арену
+template <typename F>
+void generateCatalog(const CatalogOptions &iOpt, F &&iFunc) {
+    details::SplitMix64 rng(iOpt.seed);
+
+    const size_t authorCount = std::max<size_t>(1, iOpt.authors);
+    std::vector<std::string> authors;
+    std::vector<double> authorWeights;
+    authors.reserve(authorCount);
+    authorWeights.reserve(authorCount);
+    for (size_t i = 0; i < authorCount; ++i) {
+        authors.push_back("Author " + std::to_string(i));
+        authorWeights.push_back(1. / std::pow(static_cast<double>(i + 1), iOpt.author_skew));
+    }
+    const details::CumulativeChoice pickAuthor(authorWeights);
+    const details::CumulativeChoice pickGenre(iOpt.genre_weights);
+    const auto years = static_cast<uint64_t>(std::max(0, iOpt.last_year - iOpt.first_year) + 1);
+
+    std::string title;
+    for (size_t row = 0; row < iOpt.rows; ++row) {
+        title = "Title " + std::to_string(row);
+        const auto &author = authors[pickAuthor(rng)];
+        const auto genre = static_cast<Genre>(pickGenre(rng));
+        const int year = iOpt.first_year + static_cast<int>(rng.NextBelow(years));
+        // Бокс-Мюллер, второе значение пары не используется ради простоты
+        const double u1 = 1. - rng.NextDouble();
+        const double u2 = rng.NextDouble();
+        const double normal = std::sqrt(-2. * std::log(u1)) * std::cos(2. * std::numbers::pi * u2);
+        const double rating = std::clamp(iOpt.rating_mean + iOpt.rating_stddev * normal, 0., 5.);
+        const int readCount = static_cast<int>(rng.NextBelow(10000));
+        iFunc(Book{title, author, year, genre, std::round(rating * 10.) / 10., readCount});
+    }
+}
+
+template <BookContainerLike T>
+void generateCatalog(BookDatabase<T> &ioDb, const CatalogOptions &iOpt) {
+    ioDb.Reserve(ioDb.size() + iOpt.rows);
+    generateCatalog(iOpt, [&ioDb](const Book &iBook) { ioDb.PushBack(iBook); });
+}
+
+// Тот же каталог в формате, который читает loadBooks
+inline std::string generateCatalogCsv(const CatalogOptions &iOpt, char iDelimiter = ',') {
+    std::string res = "title,author,year,genre,rating,read_count\n";
+    if (iDelimiter != ',')
+        std::replace(res.begin(), res.end(), ',', iDelimiter);
+    generateCatalog(iOpt, [&res, iDelimiter](const Book &iBook) {
+        res += std::format("{1}{0}{2}{0}{3}{0}{4}{0}{5}{0}{6}\n", iDelimiter, iBook.title, iBook.author, iBook.year,
+                           GenreName(iBook.genre), iBook.rating, iBook.read_count);
+    });
+    return res;
+}
+}  // namespace bookdb
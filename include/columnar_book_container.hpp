@@ -0,0 +1,288 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+
+namespace bookdb {
+
+// Прокси-ссылка на строку колоночного контейнера. Поля называются так же, как в Book,
+// поэтому обобщённый код вида book.rating / it->genre работает без изменений
+// и читает только те колонки, к которым обращается
+template <bool IsConst>
+struct BasicBookRef {
+    template <typename T>
+    using FieldRef = std::conditional_t<IsConst, const T &, T &>;
+
+    FieldRef<std::string_view> title;
+    FieldRef<std::string_view> author;
+    FieldRef<double> rating;
+    FieldRef<int> year;
+    FieldRef<int> read_count;
+    FieldRef<Genre> genre;
+    FieldRef<AuthorId> author_id;
+
+    constexpr BasicBookRef(FieldRef<std::string_view> iTitle, FieldRef<std::string_view> iAuthor,
+                           FieldRef<double> iRating, FieldRef<int> iYear, FieldRef<int> iReadCount,
+                           FieldRef<Genre> iGenre, FieldRef<AuthorId> iAuthorId) noexcept
+        : title(iTitle), author(iAuthor), rating(iRating), year(iYear), read_count(iReadCount), genre(iGenre),
+          author_id(iAuthorId) {}
+
+    constexpr BasicBookRef(const BasicBookRef &) = default;
+
+    template <bool OtherConst>
+        requires(IsConst && !OtherConst)
+    constexpr BasicBookRef(const BasicBookRef<OtherConst> &iOther) noexcept
+        : title(iOther.title), author(iOther.author), rating(iOther.rating), year(iOther.year),
+          read_count(iOther.read_count), genre(iOther.genre), author_id(iOther.author_id) {}
+
+    constexpr operator Book() const {
+        Book res{title, author, year, genre, rating, read_count};
+        res.author_id = author_id;
+        return res;
+    }
+
+    // Присваивание через прокси пишет в колонки, а не перепривязывает ссылки
+    constexpr const BasicBookRef &operator=(const BasicBookRef &iOther) const
+        requires(!IsConst)
+    {
+        return Assign(iOther);
+    }
+    constexpr const BasicBookRef &operator=(const Book &iBook) const
+        requires(!IsConst)
+    {
+        return Assign(iBook);
+    }
+
+    friend constexpr void swap(const BasicBookRef &lhv, const BasicBookRef &rhv) noexcept
+        requires(!IsConst)
+    {
+        using std::swap;
+        swap(lhv.title, rhv.title);
+        swap(lhv.author, rhv.author);
+        swap(lhv.rating, rhv.rating);
+        swap(lhv.year, rhv.year);
+        swap(lhv.read_count, rhv.read_count);
+        swap(lhv.genre, rhv.genre);
+        swap(lhv.author_id, rhv.author_id);
+    }
+
+private:
+    template <typename Other>
+    constexpr const BasicBookRef &Assign(const Other &iOther) const {
+        title = iOther.title;
+        author = iOther.author;
+        rating = iOther.rating;
+        year = iOther.year;
+        read_count = iOther.read_count;
+        genre = iOther.genre;
+        author_id = iOther.author_id;
+        return *this;
+    }
+};
+
+using BookRef = BasicBookRef<false>;
+using ConstBookRef = BasicBookRef<true>;
+}  // namespace bookdb
+
+namespace std {
+// Общий тип для прокси-ссылки и Book нужен, чтобы итераторы удовлетворяли std::indirectly_readable
+template <bool IsConst, template <typename> typename TQual, template <typename> typename UQual>
+struct basic_common_reference<bookdb::BasicBookRef<IsConst>, bookdb::Book, TQual, UQual> {
+    using type = bookdb::Book;
+};
+
+template <bool IsConst, template <typename> typename TQual, template <typename> typename UQual>
+struct basic_common_reference<bookdb::Book, bookdb::BasicBookRef<IsConst>, TQual, UQual> {
+    using type = bookdb::Book;
+};
+}  // namespace std
+
+namespace bookdb {
+
+// Колоночное (struct-of-arrays) хранилище книг. Каждое поле Book лежит в отдельном
+// непрерывном массиве, поэтому аналитические проходы читают только нужные колонки
+class ColumnarBookContainer {
+    template <bool IsConst>
+    class Iterator {
+        using Owner = std::conditional_t<IsConst, const ColumnarBookContainer, ColumnarBookContainer>;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Book;
+        using difference_type = std::ptrdiff_t;
+        using reference = BasicBookRef<IsConst>;
+        using pointer = void;
+
+        struct ArrowProxy {
+            reference ref;
+            constexpr const reference *operator->() const noexcept { return &ref; }
+        };
+
+        constexpr Iterator() = default;
+        constexpr Iterator(Owner *iOwner, size_t iPos) noexcept : owner_(iOwner), pos_(iPos) {}
+        template <bool OtherConst>
+            requires(IsConst && !OtherConst)
+        constexpr Iterator(const Iterator<OtherConst> &iOther) noexcept
+            : owner_(iOther.owner_), pos_(iOther.pos_) {}
+
+        constexpr reference operator*() const noexcept { return owner_->Row(pos_); }
+        constexpr ArrowProxy operator->() const noexcept { return {**this}; }
+        constexpr reference operator[](difference_type n) const noexcept { return owner_->Row(pos_ + n); }
+
+        constexpr Iterator &operator++() noexcept {
+            ++pos_;
+            return *this;
+        }
+        constexpr Iterator operator++(int) noexcept {
+            auto tmp = *this;
+            ++pos_;
+            return tmp;
+        }
+        constexpr Iterator &operator--() noexcept {
+            --pos_;
+            return *this;
+        }
+        constexpr Iterator operator--(int) noexcept {
+            auto tmp = *this;
+            --pos_;
+            return tmp;
+        }
+        constexpr Iterator &operator+=(difference_type n) noexcept {
+            pos_ += n;
+            return *this;
+        }
+        constexpr Iterator &operator-=(difference_type n) noexcept {
+            pos_ -= n;
+            return *this;
+        }
+        friend constexpr Iterator operator+(Iterator it, difference_type n) noexcept { return it += n; }
+        friend constexpr Iterator operator+(difference_type n, Iterator it) noexcept { return it += n; }
+        friend constexpr Iterator operator-(Iterator it, difference_type n) noexcept { return it -= n; }
+        friend constexpr difference_type operator-(const Iterator &lhv, const Iterator &rhv) noexcept {
+            return static_cast<difference_type>(lhv.pos_) - static_cast<difference_type>(rhv.pos_);
+        }
+
+        friend constexpr bool operator==(const Iterator &lhv, const Iterator &rhv) noexcept {
+            return lhv.pos_ == rhv.pos_;
+        }
+        friend constexpr auto operator<=>(const Iterator &lhv, const Iterator &rhv) noexcept {
+            return lhv.pos_ <=> rhv.pos_;
+        }
+
+        // Номер строки, на которую указывает итератор
+        constexpr size_t Position() const noexcept { return pos_; }
+
+    private:
+        friend class Iterator<!IsConst>;
+
+        Owner *owner_ = nullptr;
+        size_t pos_ = 0;
+    };
+
+public:
+    using value_type = Book;
+    using reference = BookRef;
+    using const_reference = ConstBookRef;
+    using size_type = size_t;
+    using difference_type = std::ptrdiff_t;
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    ColumnarBookContainer() = default;
+
+    iterator begin() noexcept { return {this, 0}; }
+    iterator end() noexcept { return {this, size()}; }
+    const_iterator begin() const noexcept { return {this, 0}; }
+    const_iterator end() const noexcept { return {this, size()}; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator{end()}; }
+    reverse_iterator rend() noexcept { return reverse_iterator{begin()}; }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{end()}; }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator{begin()}; }
+
+    bool empty() const noexcept { return ratings_.empty(); }
+    size_t size() const noexcept { return ratings_.size(); }
+
+    reference operator[](size_t iPos) noexcept { return Row(iPos); }
+    const_reference operator[](size_t iPos) const noexcept { return Row(iPos); }
+    reference front() noexcept { return Row(0); }
+    reference back() noexcept { return Row(size() - 1); }
+    const_reference front() const noexcept { return Row(0); }
+    const_reference back() const noexcept { return Row(size() - 1); }
+
+    void reserve(size_t iSize) {
+        titles_.reserve(iSize);
+        authors_.reserve(iSize);
+        ratings_.reserve(iSize);
+        years_.reserve(iSize);
+        read_counts_.reserve(iSize);
+        genres_.reserve(iSize);
+        author_ids_.reserve(iSize);
+    }
+
+    void clear() noexcept {
+        titles_.clear();
+        authors_.clear();
+        ratings_.clear();
+        years_.clear();
+        read_counts_.clear();
+        genres_.clear();
+        author_ids_.clear();
+    }
+
+    void push_back(const Book &iBook) {
+        titles_.push_back(iBook.title);
+        authors_.push_back(iBook.author);
+        ratings_.push_back(iBook.rating);
+        years_.push_back(iBook.year);
+        read_counts_.push_back(iBook.read_count);
+        genres_.push_back(iBook.genre);
+        author_ids_.push_back(iBook.author_id);
+    }
+
+    template <typename... Args>
+    reference emplace_back(Args &&...iArgs) {
+        push_back(Book(std::forward<Args>(iArgs)...));
+        return back();
+    }
+
+    // Прямой доступ к колонкам
+    std::span<const std::string_view> GetTitles() const noexcept { return titles_; }
+    std::span<const std::string_view> GetAuthors() const noexcept { return authors_; }
+    std::span<const double> GetRatings() const noexcept { return ratings_; }
+    std::span<const int> GetYears() const noexcept { return years_; }
+    std::span<const int> GetReadCounts() const noexcept { return read_counts_; }
+    std::span<const Genre> GetGenres() const noexcept { return genres_; }
+    std::span<const AuthorId> GetAuthorIds() const noexcept { return author_ids_; }
+
+private:
+    reference Row(size_t iPos) noexcept {
+        return {titles_[iPos],      authors_[iPos], ratings_[iPos],   years_[iPos],
+                read_counts_[iPos], genres_[iPos],  author_ids_[iPos]};
+    }
+    const_reference Row(size_t iPos) const noexcept {
+        return {titles_[iPos],      authors_[iPos], ratings_[iPos],   years_[iPos],
+                read_counts_[iPos], genres_[iPos],  author_ids_[iPos]};
+    }
+
+    std::vector<std::string_view> titles_;
+    std::vector<std::string_view> authors_;
+    std::vector<double> ratings_;
+    std::vector<int> years_;
+    std::vector<int> read_counts_;
+    std::vector<Genre> genres_;
+    std::vector<AuthorId> author_ids_;
+};  // end class ColumnarBookContainer
+}  // namespace bookdb
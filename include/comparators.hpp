@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstddef>
+#include <span>
+
 #include "book.hpp"
 
 namespace bookdb::comp {
@@ -8,10 +11,26 @@ struct LessByAuthor {
     bool operator()(const Book &lhv, const Book &rhv) const { return lhv.author < rhv.author; }
 };
 
+// Сравнение по заранее посчитанным рангам авторов (AuthorDictionary::BuildRanks) вместо строк.
+// Упорядочивает так же, как LessByAuthor, но только книги той базы, для словаря которой
+// построены ранги. Массив рангов должен жить, пока используется компаратор. Авторы, добавленные
+// после построения рангов, рангов не имеют и идут последними, между собой - как равные
+struct LessByAuthorRank {
+    std::span<const AuthorId> ranks;
+
+    bool operator()(const Book &lhv, const Book &rhv) const { return Rank(lhv.author_id) < Rank(rhv.author_id); }
+
+    size_t Rank(AuthorId iId) const noexcept { return iId < ranks.size() ? ranks[iId] : ranks.size(); }
+};
+
 struct LessByGenre {
     bool operator()(const Book &lhv, const Book &rhv) const { return lhv.genre < rhv.genre; }
 };
 
+struct LessByYear {
+    bool operator()(const Book &lhv, const Book &rhv) const { return lhv.year < rhv.year; }
+};
+
 struct GreaterByRating {
     bool operator()(const Book &lhv, const Book &rhv) const { return lhv.rating > rhv.rating; }
 };
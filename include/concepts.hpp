@@ -1,12 +1,22 @@
 #pragma once
 
 #include <concepts>
+#include <cstdint>
 #include <iterator>
+#include <limits>
+#include <span>
+#include <string_view>
 
 #include "book.hpp"
 
 namespace bookdb {
 using ContainedType = bookdb::Book;
+// Номер строки в хранилище BookDatabase
+using RowId = size_t;
+inline constexpr RowId kNoRow = std::numeric_limits<RowId>::max();
+// Постоянный номер книги: назначается при вставке и не меняется при уплотнении и кластеризации
+using BookId = uint64_t;
+inline constexpr BookId kNoBookId = std::numeric_limits<BookId>::max();
 
 template <typename T>
 concept BookIterator = std::same_as<ContainedType, typename T::value_type> && std::bidirectional_iterator<T>;
@@ -48,6 +58,17 @@ concept BookContainerLike = requires(T cont) {
     cont.push_back(std::declval<typename T::value_type>());
 };
 
+// Контейнер, который помимо построчного доступа отдаёт поля книг отдельными колонками
+template <typename T>
+concept ColumnarBookContainerLike = BookContainerLike<T> && requires(const T &cont) {
+    { cont.GetAuthors() } -> std::convertible_to<std::span<const std::string_view>>;
+    { cont.GetRatings() } -> std::convertible_to<std::span<const double>>;
+    { cont.GetYears() } -> std::convertible_to<std::span<const int>>;
+    { cont.GetReadCounts() } -> std::convertible_to<std::span<const int>>;
+    { cont.GetGenres() } -> std::convertible_to<std::span<const Genre>>;
+    { cont.GetAuthorIds() } -> std::convertible_to<std::span<const AuthorId>>;
+};
+
 template <typename C>
 concept HasKeyAndMapped = requires {
     typename C::key_container_type;
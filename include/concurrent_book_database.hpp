@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "heterogeneous_lookup.hpp"
+#include "metrics.hpp"
+#include "segmented_array.hpp"
+#include "statsistics.hpp"
+#include "string_arena.hpp"
+#include "thread_pool.hpp"
+
+// Шардированная база для одновременной вставки и чтения. Писатели добавляют книги
+// в сегменты своего шарда под мьютексом шарда, поэтому писатели разных шардов
+// не мешают друг другу. Читатели берут ConcurrentView - опубликованный префикс
+// каждого шарда - и читают его без блокировок: книги никогда не перемещаются
+namespace bookdb {
+
+// Словарь авторов для многих писателей. Имена распределены по полосам со своими
+// мьютексами и аренами; номер по имени ищется под мьютексом полосы, имя по номеру
+// читается без блокировок
+class ConcurrentAuthorDictionary {
+public:
+    static constexpr size_t kStripes = 16;
+
+    // Номер автора и имя в арене словаря
+    std::pair<AuthorId, std::string_view> Intern(std::string_view iName) {
+        Stripe &stripe = stripes_[TransparentStringHash{}(iName) % kStripes];
+        std::lock_guard lock(stripe.mutex);
+        if (auto it = stripe.ids.find(iName); it != stripe.ids.end()) {
+            BOOKDB_METRIC_ADD(AuthorInternHits, 1);
+            return {it->second, it->first};
+        }
+        BOOKDB_METRIC_ADD(AuthorInternMisses, 1);
+        const std::string_view stored = stripe.names.Store(iName);
+        const AuthorId id = AddName(stored);
+        stripe.ids.emplace(stored, id);
+        return {id, stored};
+    }
+
+    AuthorId Find(std::string_view iName) const {
+        const Stripe &stripe = stripes_[TransparentStringHash{}(iName) % kStripes];
+        std::lock_guard lock(stripe.mutex);
+        auto it = stripe.ids.find(iName);
+        return it != stripe.ids.end() ? it->second : kNoAuthorId;
+    }
+
+    // Без блокировок, для номеров из опубликованных книг или меньших size()
+    std::string_view GetName(AuthorId iId) const noexcept { return names_[iId]; }
+    size_t size() const noexcept { return names_.GetPublished(); }
+
+private:
+    struct Stripe {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string_view, AuthorId, TransparentStringHash, TransparentStringEqual> ids;
+        StringArena names{4096};
+    };
+
+    // Новые авторы редки, поэтому выдача номеров идёт под одним общим мьютексом
+    AuthorId AddName(std::string_view iName) {
+        std::lock_guard lock(names_mutex_);
+        if (names_.GetUnpublished() >= kNoAuthorId)
+            throw std::runtime_error{"Too many authors"};
+        const auto id = static_cast<AuthorId>(names_.GetUnpublished());
+        names_.Append(iName);
+        names_.Publish();
+        return id;
+    }
+
+    std::array<Stripe, kStripes> stripes_;
+    std::mutex names_mutex_;
+    SegmentedArray<std::string_view> names_;
+};
+
+class ConcurrentBookDatabase;
+
+// Согласованный срез базы: в каждом шарде видны книги, опубликованные до создания среза.
+// Порядок книг между шардами не определён. Срез действителен, пока жива база
+class ConcurrentView {
+public:
+    size_t size() const noexcept {
+        size_t res = 0;
+        for (size_t count : counts_)
+            res += count;
+        return res;
+    }
+    bool empty() const noexcept { return size() == 0; }
+    size_t GetShardCount() const noexcept { return counts_.size(); }
+    size_t GetShardSize(size_t iShard) const noexcept { return counts_[iShard]; }
+    // Число авторов не меньше любого номера автора в срезе
+    size_t GetAuthorCount() const noexcept { return authors_; }
+    const ConcurrentAuthorDictionary &GetAuthors() const noexcept;
+
+    // iFunc(std::span<const Book>) для непрерывных кусков шарда
+    template <typename F>
+    void ForEachSegment(size_t iShard, F &&iFunc) const;
+
+    template <typename F>
+    void ForEach(F &&iFunc) const {
+        for (size_t shard = 0; shard < GetShardCount(); ++shard)
+            ForEachSegment(shard, [&](std::span<const Book> segment) {
+                for (const Book &book : segment)
+                    iFunc(book);
+            });
+    }
+
+private:
+    friend class ConcurrentBookDatabase;
+    explicit ConcurrentView(const ConcurrentBookDatabase &iDb);
+
+    const ConcurrentBookDatabase *db_;
+    std::vector<size_t> counts_;
+    size_t authors_ = 0;
+};
+
+class ConcurrentBookDatabase {
+public:
+    explicit ConcurrentBookDatabase(size_t iShards = std::max(1u, std::thread::hardware_concurrency()))
+        : shards_(std::max<size_t>(1, iShards)) {}
+
+    ConcurrentBookDatabase(const ConcurrentBookDatabase &) = delete;
+    ConcurrentBookDatabase &operator=(const ConcurrentBookDatabase &) = delete;
+
+    // Поток пишет в закреплённый за ним шард, так что постоянные писатели почти не конкурируют
+    void PushBack(const Book &iBook) { Append(LocalShard(), std::span<const Book>(&iBook, 1)); }
+
+    template <typename... Args>
+    void EmplaceBack(Args &&...iArgs) {
+        PushBack(Book(std::forward<Args>(iArgs)...));
+    }
+
+    // Пакет книг вставляется под одной блокировкой шарда и публикуется целиком
+    void Append(std::span<const Book> iBooks) { Append(LocalShard(), iBooks); }
+
+    ConcurrentView GetView() const { return ConcurrentView(*this); }
+    const ConcurrentAuthorDictionary &GetAuthors() const noexcept { return authors_; }
+    size_t GetShardCount() const noexcept { return shards_.size(); }
+
+private:
+    friend class ConcurrentView;
+
+    struct Shard {
+        std::mutex mutex;
+        SegmentedArray<Book> books;
+        StringArena titles;
+    };
+
+    size_t LocalShard() const noexcept {
+        static thread_local const size_t hash = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        return hash % shards_.size();
+    }
+
+    void Append(size_t iShard, std::span<const Book> iBooks) {
+        BOOKDB_METRIC_TIMER(Insert);
+        // Авторы интернируются до захвата шарда: словарь блокирует только свою полосу
+        std::vector<std::pair<AuthorId, std::string_view>> authors;
+        authors.reserve(iBooks.size());
+        for (const Book &book : iBooks)
+            authors.push_back(authors_.Intern(book.author));
+
+        Shard &shard = shards_[iShard];
+        std::lock_guard lock(shard.mutex);
+        for (size_t i = 0; i < iBooks.size(); ++i) {
+            Book &book = shard.books.Append(iBooks[i]);
+            book.title = shard.titles.Store(book.title);
+            std::tie(book.author_id, book.author) = authors[i];
+        }
+        shard.books.Publish();
+        BOOKDB_METRIC_ADD(Inserts, iBooks.size());
+    }
+
+    std::vector<Shard> shards_;
+    ConcurrentAuthorDictionary authors_;
+};
+
+inline ConcurrentView::ConcurrentView(const ConcurrentBookDatabase &iDb) : db_(&iDb) {
+    counts_.reserve(iDb.shards_.size());
+    for (const auto &shard : iDb.shards_)
+        counts_.push_back(shard.books.GetPublished());
+    // Авторы читаются после книг: номер автора публикуется раньше любой книги с ним
+    authors_ = iDb.authors_.size();
+}
+
+inline const ConcurrentAuthorDictionary &ConcurrentView::GetAuthors() const noexcept { return db_->authors_; }
+
+template <typename F>
+void ConcurrentView::ForEachSegment(size_t iShard, F &&iFunc) const {
+    db_->shards_[iShard].books.ForEachSegment(counts_[iShard], iFunc);
+}
+
+namespace details {
+// Шарды делятся между частями ParallelFor; iFunc(part, shard) вызывается для каждого шарда части
+template <typename F>
+void ForEachShardParallel(const ConcurrentView &iView, const Parallelism &iPar, F &&iFunc) {
+    Parallelism par = iPar;
+    par.min_part_size = 1;
+    ParallelFor(iView.GetShardCount(), par, [&](size_t part, size_t begin, size_t end) {
+        for (size_t shard = begin; shard < end; ++shard)
+            iFunc(part, shard);
+    });
+}
+}  // namespace details
+
+// Фильтр и статистика по срезу расходятся по шардам параллельно, частичные результаты
+// сливаются в порядке шардов
+
+template <typename P>
+std::vector<std::reference_wrapper<const Book>> filterBooks(const ConcurrentView &iView, const P &iPred,
+                                                            const Parallelism &iPar = {}) {
+    BOOKDB_METRIC_TIMER(Filter);
+    std::vector<std::vector<std::reference_wrapper<const Book>>> partials(iView.GetShardCount());
+    details::ForEachShardParallel(iView, iPar, [&](size_t, size_t shard) {
+        iView.ForEachSegment(shard, [&](std::span<const Book> segment) {
+            for (const Book &book : segment)
+                if (iPred(book))
+                    partials[shard].emplace_back(book);
+        });
+    });
+
+    std::vector<std::reference_wrapper<const Book>> res;
+    for (auto &partial : partials)
+        res.insert(res.end(), partial.begin(), partial.end());
+    BOOKDB_METRIC_ADD(FilterCalls, 1);
+    BOOKDB_METRIC_ADD(RowsScanned, iView.size());
+    BOOKDB_METRIC_ADD(RowsSelected, res.size());
+    return res;
+}
+
+inline double calculateAverageRating(const ConcurrentView &iView, const Parallelism &iPar = {}) {
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    std::vector<double> sums(iView.GetShardCount());
+    details::ForEachShardParallel(iView, iPar, [&](size_t, size_t shard) {
+        iView.ForEachSegment(shard, [&](std::span<const Book> segment) {
+            for (const Book &book : segment)
+                sums[shard] += book.rating;
+        });
+    });
+
+    double sum = 0.;
+    for (double s : sums)
+        sum += s;
+    return !iView.empty() ? sum / iView.size() : 0.;
+}
+
+inline GenreRatingsFlatCont<std::less<Genre>> calculateGenreRatings(const ConcurrentView &iView,
+                                                                    const Parallelism &iPar = {}) {
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    using Partial = std::array<std::pair<double, size_t>, kGenreCount>;
+    std::vector<Partial> partials(iView.GetShardCount());
+    details::ForEachShardParallel(iView, iPar, [&](size_t, size_t shard) {
+        iView.ForEachSegment(shard, [&](std::span<const Book> segment) {
+            for (const Book &book : segment) {
+                auto &[totalRating, count] = partials[shard][details::GenreSlot(book.genre)];
+                totalRating += book.rating;
+                ++count;
+            }
+        });
+    });
+
+    GenreRatingsFlatCont<std::less<Genre>> res;
+    for (size_t i = 0; i < kGenreCount; ++i) {
+        double totalRating = 0.;
+        size_t count = 0;
+        for (const auto &partial : partials) {
+            totalRating += partial[i].first;
+            count += partial[i].second;
+        }
+        res[static_cast<Genre>(i)] = count ? totalRating / count : 0.;
+    }
+    return res;
+}
+
+// Число книг каждого автора, индекс - номер автора в словаре базы
+inline std::vector<size_t> buildAuthorHistogramDense(const ConcurrentView &iView, const Parallelism &iPar = {}) {
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    std::vector<std::vector<size_t>> partials(iView.GetShardCount());
+    details::ForEachShardParallel(iView, iPar, [&](size_t, size_t shard) {
+        auto &local = partials[shard];
+        local.assign(iView.GetAuthorCount(), 0);
+        iView.ForEachSegment(shard, [&](std::span<const Book> segment) {
+            for (const Book &book : segment)
+                ++local[book.author_id];
+        });
+    });
+
+    std::vector<size_t> res(iView.GetAuthorCount());
+    for (const auto &partial : partials)
+        for (size_t id = 0; id < res.size(); ++id)
+            res[id] += partial[id];
+    return res;
+}
+}  // namespace bookdb
@@ -0,0 +1,190 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+
+namespace bookdb {
+namespace details {
+// Единственный ли владелец. Счётчик ссылок читается без синхронизации: барьер упорядочивает
+// последующую запись после того, как последняя копия, читавшая объект, его отпустила
+template <typename T>
+bool IsUniqueOwner(const std::shared_ptr<T> &iPtr) noexcept {
+    if (iPtr.use_count() != 1)
+        return false;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return true;
+}
+}  // namespace details
+
+// Массив с копированием при записи. Элементы лежат в кусках по ChunkSize, куски и список кусков
+// разделяются между копиями через счётчики ссылок, поэтому копия стоит O(1). Первая запись после
+// копирования копирует список кусков (O(N / ChunkSize)) и тот кусок, в который пишет; остальные
+// куски остаются общими. Копию можно читать из другого потока, пока владелец оригинала пишет в него.
+// Итерация только на чтение - запись идёт через неконстантные operator[], front и back
+template <typename T, size_t ChunkSize = 4096>
+class CowArray {
+    using Chunk = std::vector<T>;
+    using Spine = std::vector<std::shared_ptr<Chunk>>;
+
+public:
+    static constexpr size_t kChunkSize = ChunkSize;
+
+    class Iterator {
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = const T &;
+        using pointer = const T *;
+
+        Iterator() = default;
+        Iterator(const CowArray *iArray, size_t iPos) noexcept : array_(iArray), pos_(iPos) {}
+
+        reference operator*() const noexcept { return (*array_)[pos_]; }
+        pointer operator->() const noexcept { return &**this; }
+        reference operator[](difference_type iOffset) const noexcept { return *(*this + iOffset); }
+
+        Iterator &operator++() noexcept {
+            ++pos_;
+            return *this;
+        }
+        Iterator operator++(int) noexcept { return {array_, pos_++}; }
+        Iterator &operator--() noexcept {
+            --pos_;
+            return *this;
+        }
+        Iterator operator--(int) noexcept { return {array_, pos_--}; }
+        Iterator &operator+=(difference_type iOffset) noexcept {
+            pos_ += iOffset;
+            return *this;
+        }
+        Iterator &operator-=(difference_type iOffset) noexcept {
+            pos_ -= iOffset;
+            return *this;
+        }
+        friend Iterator operator+(Iterator iIt, difference_type iOffset) noexcept { return iIt += iOffset; }
+        friend Iterator operator+(difference_type iOffset, Iterator iIt) noexcept { return iIt += iOffset; }
+        friend Iterator operator-(Iterator iIt, difference_type iOffset) noexcept { return iIt -= iOffset; }
+        friend difference_type operator-(const Iterator &iLhs, const Iterator &iRhs) noexcept {
+            return static_cast<difference_type>(iLhs.pos_) - static_cast<difference_type>(iRhs.pos_);
+        }
+        friend bool operator==(const Iterator &iLhs, const Iterator &iRhs) noexcept { return iLhs.pos_ == iRhs.pos_; }
+        friend auto operator<=>(const Iterator &iLhs, const Iterator &iRhs) noexcept { return iLhs.pos_ <=> iRhs.pos_; }
+
+    private:
+        const CowArray *array_ = nullptr;
+        size_t pos_ = 0;
+    };
+
+    using value_type = T;
+    using reference = T &;
+    using const_reference = const T &;
+    using iterator = Iterator;
+    using const_iterator = Iterator;
+    using reverse_iterator = std::reverse_iterator<Iterator>;
+    using const_reverse_iterator = std::reverse_iterator<Iterator>;
+
+    iterator begin() const noexcept { return {this, 0}; }
+    iterator end() const noexcept { return {this, size_}; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() const noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() const noexcept { return reverse_iterator(begin()); }
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    const T &operator[](size_t iPos) const noexcept { return (*(*spine_)[iPos / ChunkSize])[iPos % ChunkSize]; }
+    const T &front() const noexcept { return (*this)[0]; }
+    const T &back() const noexcept { return (*this)[size_ - 1]; }
+
+    // Запись отделяет кусок от копий
+    T &operator[](size_t iPos) { return MutableChunk(iPos / ChunkSize)[iPos % ChunkSize]; }
+    T &front() { return (*this)[0]; }
+    T &back() { return (*this)[size_ - 1]; }
+
+    template <typename... Args>
+    T &emplace_back(Args &&...iArgs) {
+        Spine &spine = MutableSpine();
+        if (size_ % ChunkSize == 0) {
+            spine.push_back(std::make_shared<Chunk>());
+            spine.back()->reserve(ChunkSize);
+        }
+        T &res = MutableChunk(spine.size() - 1).emplace_back(std::forward<Args>(iArgs)...);
+        ++size_;
+        return res;
+    }
+    void push_back(const T &iValue) { emplace_back(iValue); }
+    void push_back(T &&iValue) { emplace_back(std::move(iValue)); }
+
+    void reserve(size_t iSize) { MutableSpine().reserve((iSize + ChunkSize - 1) / ChunkSize); }
+
+    void resize(size_t iSize, const T &iValue = T{}) {
+        while (size_ > iSize) {
+            Chunk &last = MutableChunk(spine_->size() - 1);
+            const size_t drop = std::min(last.size(), size_ - iSize);
+            last.resize(last.size() - drop);
+            size_ -= drop;
+            if (last.empty())
+                spine_->pop_back();
+        }
+        while (size_ < iSize)
+            emplace_back(iValue);
+    }
+
+    void assign(size_t iSize, const T &iValue) {
+        clear();
+        resize(iSize, iValue);
+    }
+
+    // Остальные копии сохраняют свои элементы
+    void clear() noexcept {
+        spine_.reset();
+        size_ = 0;
+    }
+
+    // Сколько кусков этот массив делит с другими копиями
+    size_t GetSharedChunkCount() const noexcept {
+        size_t res = 0;
+        if (spine_)
+            for (const auto &chunk : *spine_)
+                res += spine_.use_count() > 1 || chunk.use_count() > 1;
+        return res;
+    }
+
+private:
+    Spine &MutableSpine() {
+        if (!spine_)
+            spine_ = std::make_shared<Spine>();
+        else if (!details::IsUniqueOwner(spine_))
+            spine_ = std::make_shared<Spine>(*spine_);
+        return *spine_;
+    }
+
+    Chunk &MutableChunk(size_t iChunk) {
+        std::shared_ptr<Chunk> &chunk = MutableSpine()[iChunk];
+        if (!details::IsUniqueOwner(chunk)) {
+            auto copy = std::make_shared<Chunk>();
+            copy->reserve(ChunkSize);
+            copy->assign(chunk->begin(), chunk->end());
+            chunk = std::move(copy);
+        }
+        return *chunk;
+    }
+
+    std::shared_ptr<Spine> spine_;
+    size_t size_ = 0;
+};
+
+// Хранилище книг для BookDatabase со снимками за O(1), см. BookDatabase::TakeSnapshot
+using CowBookContainer = CowArray<Book>;
+}  // namespace bookdb
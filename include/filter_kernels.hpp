@@ -0,0 +1,90 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "book.hpp"
+#include "selection_bitmap.hpp"
+
+// Векторные ядра для типовых предикатов. Каждое ядро проходит по одной колонке и пишет
+// результат сравнения в слова битовой маски без ветвлений. При сборке с AVX2 (-mavx2 или
+// BOOKDB_ENABLE_AVX2) используются интринсики, иначе - скалярный цикл, который компилятор векторизует сам
+namespace bookdb::kernels {
+using Word = SelectionBitmap::Word;
+constexpr size_t kWordBits = SelectionBitmap::kWordBits;
+
+namespace details {
+// Скалярная обработка строк [iFrom, size) - хвост после SIMD-части или весь диапазон без AVX2
+template <typename T, typename Cond>
+constexpr void ScalarKernel(std::span<const T> iColumn, size_t iFrom, std::span<Word> oWords, Cond iCond) {
+    for (size_t base = iFrom; base < iColumn.size(); base += kWordBits) {
+        const size_t count = std::min(kWordBits, iColumn.size() - base);
+        Word w = 0;
+        for (size_t j = 0; j < count; ++j)
+            w |= Word{iCond(iColumn[base + j])} << j;
+        oWords[base / kWordBits] = w;
+    }
+}
+}  // namespace details
+
+inline void YearBetween(std::span<const int> iYears, int iStart, int iEnd, std::span<Word> oWords) {
+    size_t done = 0;
+#if defined(__AVX2__)
+    const __m256i lo = _mm256_set1_epi32(iStart);
+    const __m256i hi = _mm256_set1_epi32(iEnd);
+    for (; done + kWordBits <= iYears.size(); done += kWordBits) {
+        Word w = 0;
+        for (size_t k = 0; k < kWordBits / 8; ++k) {
+            const __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(iYears.data() + done + k * 8));
+            const __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(lo, y), _mm256_cmpgt_epi32(y, hi));
+            const auto bits = static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(outside))) ^ 0xFFu;
+            w |= Word{bits} << (k * 8);
+        }
+        oWords[done / kWordBits] = w;
+    }
+#endif
+    details::ScalarKernel(iYears, done, oWords, [iStart, iEnd](int y) { return iStart <= y && y <= iEnd; });
+}
+
+inline void RatingAbove(std::span<const double> iRatings, double iMinRating, std::span<Word> oWords) {
+    size_t done = 0;
+#if defined(__AVX2__)
+    const __m256d min = _mm256_set1_pd(iMinRating);
+    for (; done + kWordBits <= iRatings.size(); done += kWordBits) {
+        Word w = 0;
+        for (size_t k = 0; k < kWordBits / 4; ++k) {
+            const __m256d r = _mm256_loadu_pd(iRatings.data() + done + k * 4);
+            const auto bits = static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(r, min, _CMP_GT_OQ)));
+            w |= Word{bits} << (k * 4);
+        }
+        oWords[done / kWordBits] = w;
+    }
+#endif
+    details::ScalarKernel(iRatings, done, oWords, [iMinRating](double r) { return r > iMinRating; });
+}
+
+inline void GenreIs(std::span<const Genre> iGenres, Genre iGenre, std::span<Word> oWords) {
+    static_assert(sizeof(Genre) == sizeof(std::int32_t));
+    size_t done = 0;
+#if defined(__AVX2__)
+    const __m256i target = _mm256_set1_epi32(static_cast<std::int32_t>(iGenre));
+    for (; done + kWordBits <= iGenres.size(); done += kWordBits) {
+        Word w = 0;
+        for (size_t k = 0; k < kWordBits / 8; ++k) {
+            const __m256i g = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(iGenres.data() + done + k * 8));
+            const auto bits =
+                static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(g, target))));
+            w |= Word{bits} << (k * 8);
+        }
+        oWords[done / kWordBits] = w;
+    }
+#endif
+    details::ScalarKernel(iGenres, done, oWords, [iGenre](Genre g) { return g == iGenre; });
+}
+}  // namespace bookdb::kernels
@@ -2,40 +2,181 @@
 
 #include <algorithm>
 #include <functional>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 #include "book.hpp"
 #include "concepts.hpp"
+#include "metrics.hpp"
 
 namespace bookdb {
-auto YearBetween(int iStart, int iEnd) {
-    return [iStart, iEnd](const Book &book) { return iStart <= book.year && book.year <= iEnd; };
-}
+namespace pred {
+// Предикаты - именованные типы, а не лямбды, чтобы фильтрующий движок мог распознать их
+// и вычислить над колонкой векторным ядром. Для построчного вызова они по-прежнему обычные функторы
+struct YearBetween {
+    int start;
+    int end;
 
-auto RatingAbove(double iMinRating) {
-    return [iMinRating](const Book &book) { return book.rating > iMinRating; };
-}
+    template <typename B>
+    constexpr bool operator()(const B &book) const noexcept {
+        return start <= book.year && book.year <= end;
+    }
+};
 
-auto GenreIs(Genre iGenre) {
-    return [iGenre](const Book &book) { return book.genre == iGenre; };
-}
+struct RatingAbove {
+    double min_rating;
+
+    template <typename B>
+    constexpr bool operator()(const B &book) const noexcept {
+        return book.rating > min_rating;
+    }
+};
+
+struct GenreIs {
+    Genre genre;
+
+    template <typename B>
+    constexpr bool operator()(const B &book) const noexcept {
+        return book.genre == genre;
+    }
+};
+
+struct AuthorIs {
+    std::string_view author;
+
+    template <typename B>
+    constexpr bool operator()(const B &book) const noexcept {
+        return book.author == author;
+    }
+};
 
 template <typename... Predicates>
-auto all_of(Predicates &&...preds) {
-    return [preds...](const Book &book) { return (preds(book) && ...); };
+struct AllOf {
+    std::tuple<Predicates...> preds;
+
+    template <typename B>
+    constexpr bool operator()(const B &book) const {
+        return std::apply([&book](const auto &...p) { return (p(book) && ...); }, preds);
+    }
+};
+
+template <typename... Predicates>
+struct AnyOf {
+    std::tuple<Predicates...> preds;
+
+    template <typename B>
+    constexpr bool operator()(const B &book) const {
+        return std::apply([&book](const auto &...p) { return (p(book) || ...); }, preds);
+    }
+};
+}  // namespace pred
+
+namespace details {
+template <typename P>
+inline constexpr bool IsAllOf = false;
+template <typename... Ps>
+inline constexpr bool IsAllOf<pred::AllOf<Ps...>> = true;
+
+template <typename P>
+inline constexpr bool IsAnyOf = false;
+template <typename... Ps>
+inline constexpr bool IsAnyOf<pred::AnyOf<Ps...>> = true;
+}  // namespace details
+
+constexpr pred::YearBetween YearBetween(int iStart, int iEnd) { return {iStart, iEnd}; }
+
+constexpr pred::RatingAbove RatingAbove(double iMinRating) { return {iMinRating}; }
+
+constexpr pred::GenreIs GenreIs(Genre iGenre) { return {iGenre}; }
+
+constexpr pred::AuthorIs AuthorIs(std::string_view iAuthor) { return {iAuthor}; }
+
+template <typename... Predicates>
+constexpr auto all_of(Predicates &&...preds) {
+    return pred::AllOf<std::decay_t<Predicates>...>{{std::forward<Predicates>(preds)...}};
 }
 
 template <typename... Predicates>
-auto any_of(Predicates &&...preds) {
-    return [preds...](const Book &book) { return (preds(book) || ...); };
+constexpr auto any_of(Predicates &&...preds) {
+    return pred::AnyOf<std::decay_t<Predicates>...>{{std::forward<Predicates>(preds)...}};
 }
 
+// Результат растёт по мере нахождения совпадений: память пропорциональна выборке, а не базе
 template <ConstBookIterator T>
 std::vector<std::reference_wrapper<const Book>> filterBooks(T begin, T end, auto &&cmp) {
+    BOOKDB_METRIC_TIMER(Filter);
 
     std::vector<std::reference_wrapper<const Book>> result;
-    result.reserve(std::distance(begin, end));
-
-    std::copy_if(begin, end, std::back_inserter(result), [&cmp](const auto &book) { return cmp(book); });
+    size_t scanned = 0;
+    for (; begin != end; ++begin, ++scanned)
+        if (cmp(*begin))
+            result.emplace_back(*begin);
+    BOOKDB_METRIC_ADD(FilterCalls, 1);
+    BOOKDB_METRIC_ADD(RowsScanned, scanned);
+    BOOKDB_METRIC_ADD(RowsSelected, result.size());
     return result;
 }
-}  // namespace bookdb
\ No newline at end of file
+
+// Ленивая выборка: совпадения находятся по одному при обходе, ничего не выделяется.
+// Первое совпадение доступно сразу, обход можно прервать в любой момент
+template <ConstBookIterator T, typename P>
+auto filterView(T begin, T end, P pred) {
+    return std::ranges::subrange(begin, end) | std::views::filter(std::move(pred));
+}
+
+// Выборка пакетами по iChunkSize ссылок в одном переиспользуемом буфере.
+// iFunc(std::span<const std::reference_wrapper<const Book>>) может вернуть false, чтобы остановить обход.
+// Возвращает число переданных совпадений
+template <ConstBookIterator T, typename P, typename F>
+size_t forEachFilteredChunk(T begin, T end, const P &iPred, size_t iChunkSize, F &&iFunc) {
+    BOOKDB_METRIC_TIMER(Filter);
+    using Chunk = std::span<const std::reference_wrapper<const Book>>;
+
+    // reserve может выделить больше запрошенного, поэтому граница куска - chunkSize, а не capacity
+    const size_t chunkSize = std::max<size_t>(1, iChunkSize);
+    std::vector<std::reference_wrapper<const Book>> chunk;
+    chunk.reserve(chunkSize);
+    size_t scanned = 0;
+    size_t selected = 0;
+    bool stopped = false;
+    auto flush = [&] {
+        selected += chunk.size();
+        if constexpr (std::is_same_v<std::invoke_result_t<F &, Chunk>, bool>)
+            stopped = !iFunc(Chunk(chunk));
+        else
+            iFunc(Chunk(chunk));
+        chunk.clear();
+    };
+
+    for (; begin != end && !stopped; ++begin, ++scanned)
+        if (iPred(*begin)) {
+            chunk.emplace_back(*begin);
+            if (chunk.size() == chunkSize)
+                flush();
+        }
+    if (!chunk.empty() && !stopped)
+        flush();
+    BOOKDB_METRIC_ADD(FilterCalls, 1);
+    BOOKDB_METRIC_ADD(RowsScanned, scanned);
+    BOOKDB_METRIC_ADD(RowsSelected, selected);
+    return selected;
+}
+
+// Только число совпадений, без материализации
+template <ConstBookIterator T, typename P>
+size_t countBooks(T begin, T end, const P &iPred) {
+    BOOKDB_METRIC_TIMER(Filter);
+    size_t scanned = 0;
+    size_t selected = 0;
+    for (; begin != end; ++begin, ++scanned)
+        selected += iPred(*begin) ? 1 : 0;
+    BOOKDB_METRIC_ADD(FilterCalls, 1);
+    BOOKDB_METRIC_ADD(RowsScanned, scanned);
+    BOOKDB_METRIC_ADD(RowsSelected, selected);
+    return selected;
+}
+}  // namespace bookdb
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <compare>
 #include <functional>
 #include <string>
 #include <string_view>
@@ -28,6 +29,20 @@ struct TransparentStringEqual {
     }
 };
 
+// Строка вместе с уже посчитанным TransparentStringHash хешем: поиск в таблице с прозрачным
+// хешем не хеширует её повторно
+struct PrehashedString {
+    std::string_view str;
+    std::size_t hash;
+
+    friend constexpr bool operator==(const PrehashedString &lhs, std::string_view rhs) noexcept {
+        return lhs.str == rhs;
+    }
+    friend constexpr auto operator<=>(const PrehashedString &lhs, std::string_view rhs) noexcept {
+        return lhs.str <=> rhs;
+    }
+};
+
 struct TransparentStringHash {
     using is_transparent = void;
 
@@ -36,6 +51,8 @@ struct TransparentStringHash {
     std::size_t operator()(const std::string &s) const noexcept { return std::hash<std::string>{}(s); }
 
     std::size_t operator()(const char *s) const noexcept { return std::hash<std::string_view>{}(s); }
+
+    std::size_t operator()(const PrehashedString &s) const noexcept { return s.hash; }
 };
 
 }  // namespace bookdb
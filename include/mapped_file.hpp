@@ -0,0 +1,84 @@
+#pragma once
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace bookdb {
+
+// Файл, отображённый в память только для чтения. Содержимое доступно как string_view
+// без копирования, отображение снимается при разрушении
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path &iPath) {
+        const int fd = ::open(iPath.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            throw std::runtime_error{"Cannot open " + iPath.string() + ": " + std::strerror(errno)};
+
+        struct stat st{};
+        if (::fstat(fd, &st) != 0) {
+            const int err = errno;
+            ::close(fd);
+            throw std::runtime_error{"Cannot stat " + iPath.string() + ": " + std::strerror(err)};
+        }
+        size_ = static_cast<size_t>(st.st_size);
+        // Пустой файл отобразить нельзя, он просто остаётся пустым
+        if (size_ > 0) {
+            void *addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED) {
+                const int err = errno;
+                ::close(fd);
+                throw std::runtime_error{"Cannot mmap " + iPath.string() + ": " + std::strerror(err)};
+            }
+            data_ = static_cast<const char *>(addr);
+        }
+        // Отображение живёт независимо от дескриптора
+        ::close(fd);
+    }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    MappedFile(MappedFile &&iOther) noexcept
+        : data_(std::exchange(iOther.data_, nullptr)), size_(std::exchange(iOther.size_, 0)) {}
+    MappedFile &operator=(MappedFile &&iOther) noexcept {
+        if (this != &iOther) {
+            Unmap();
+            data_ = std::exchange(iOther.data_, nullptr);
+            size_ = std::exchange(iOther.size_, 0);
+        }
+        return *this;
+    }
+    ~MappedFile() { Unmap(); }
+
+    // Подсказка ядру о порядке чтения, ошибки не критичны
+    void AdviseSequential() const noexcept {
+        if (data_)
+            ::madvise(const_cast<char *>(data_), size_, MADV_SEQUENTIAL);
+    }
+
+    std::string_view GetData() const noexcept { return {data_, size_}; }
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+private:
+    void Unmap() noexcept {
+        if (data_)
+            ::munmap(const_cast<char *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+};
+}  // namespace bookdb
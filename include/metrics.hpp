@@ -0,0 +1,311 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Встроенные счётчики операций и гистограммы задержек. Включаются определением
+// BOOKDB_ENABLE_METRICS (опция CMake с тем же именем); без него макросы
+// BOOKDB_METRIC_* раскрываются в пустые выражения и не вычисляют аргументы,
+// а Collect() возвращает нули. Каждый поток пишет только в свои счётчики,
+// без атомарных RMW-операций; Collect() суммирует все потоки под мьютексом реестра
+namespace bookdb::metrics {
+namespace details {
+class ThreadMetrics;
+}  // namespace details
+
+#ifdef BOOKDB_ENABLE_METRICS
+inline constexpr bool kEnabled = true;
+#else
+inline constexpr bool kEnabled = false;
+#endif
+
+enum class Counter : size_t {
+    Inserts,
+    AuthorInternHits,
+    AuthorInternMisses,
+    FilterCalls,
+    RowsScanned,
+    RowsSelected,
+    TopKCalls,
+    StatsCalls,
+    Count
+};
+
+enum class Operation : size_t { Insert, Filter, TopK, Stats, Count };
+
+inline constexpr size_t kCounterCount = static_cast<size_t>(Counter::Count);
+inline constexpr size_t kOperationCount = static_cast<size_t>(Operation::Count);
+
+constexpr std::string_view CounterName(Counter iCounter) {
+    constexpr std::array<std::string_view, kCounterCount> names{
+        "inserts",      "author_intern_hits", "author_intern_misses", "filter_calls",
+        "rows_scanned", "rows_selected",      "top_k_calls",          "stats_calls"};
+    return names[static_cast<size_t>(iCounter)];
+}
+
+constexpr std::string_view OperationName(Operation iOperation) {
+    constexpr std::array<std::string_view, kOperationCount> names{"insert", "filter", "top_k", "stats"};
+    return names[static_cast<size_t>(iOperation)];
+}
+
+// Гистограмма задержек с корзинами по степеням двойки наносекунд:
+// корзина i содержит длительности из [2^(i-1), 2^i), корзина 0 - нулевые
+class LatencyHistogram {
+public:
+    static constexpr size_t kBuckets = 48;
+
+    static constexpr size_t BucketOf(uint64_t iNs) noexcept {
+        return std::min<size_t>(std::bit_width(iNs), kBuckets - 1);
+    }
+    // Верхняя граница корзины
+    static constexpr uint64_t BucketLimit(size_t iBucket) noexcept { return uint64_t{1} << iBucket; }
+
+    void Record(uint64_t iNs) noexcept {
+        ++buckets_[BucketOf(iNs)];
+        total_ns_ += iNs;
+    }
+    void Merge(const LatencyHistogram &iOther) noexcept {
+        for (size_t i = 0; i < kBuckets; ++i)
+            buckets_[i] += iOther.buckets_[i];
+        total_ns_ += iOther.total_ns_;
+    }
+    // Обратная к Merge: iOther должна быть частью этой гистограммы
+    void Subtract(const LatencyHistogram &iOther) noexcept {
+        for (size_t i = 0; i < kBuckets; ++i)
+            buckets_[i] -= iOther.buckets_[i];
+        total_ns_ -= iOther.total_ns_;
+    }
+
+    uint64_t GetCount() const noexcept {
+        uint64_t res = 0;
+        for (uint64_t b : buckets_)
+            res += b;
+        return res;
+    }
+    uint64_t GetTotalNs() const noexcept { return total_ns_; }
+    double GetMeanNs() const noexcept {
+        const uint64_t count = GetCount();
+        return count ? static_cast<double>(total_ns_) / count : 0.;
+    }
+    // Оценка квантиля сверху - граница корзины, в которую он попал
+    uint64_t GetQuantileNs(double iQ) const noexcept {
+        const uint64_t count = GetCount();
+        if (count == 0)
+            return 0;
+        const auto rank = static_cast<uint64_t>(std::clamp(iQ, 0., 1.) * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i)
+            if ((seen += buckets_[i]) >= rank)
+                return BucketLimit(i);
+        return BucketLimit(kBuckets - 1);
+    }
+    std::span<const uint64_t> GetBuckets() const noexcept { return buckets_; }
+
+private:
+    friend class details::ThreadMetrics;
+
+    std::array<uint64_t, kBuckets> buckets_{};
+    uint64_t total_ns_ = 0;
+};
+
+// Сумма метрик всех потоков на момент вызова Collect()
+struct MetricsSnapshot {
+    std::array<uint64_t, kCounterCount> counters{};
+    std::array<LatencyHistogram, kOperationCount> latencies{};
+
+    uint64_t Get(Counter iCounter) const noexcept { return counters[static_cast<size_t>(iCounter)]; }
+    const LatencyHistogram &GetLatency(Operation iOperation) const noexcept {
+        return latencies[static_cast<size_t>(iOperation)];
+    }
+
+    void Merge(const MetricsSnapshot &iOther) noexcept {
+        for (size_t i = 0; i < kCounterCount; ++i)
+            counters[i] += iOther.counters[i];
+        for (size_t i = 0; i < kOperationCount; ++i)
+            latencies[i].Merge(iOther.latencies[i]);
+    }
+    void Subtract(const MetricsSnapshot &iOther) noexcept {
+        for (size_t i = 0; i < kCounterCount; ++i)
+            counters[i] -= iOther.counters[i];
+        for (size_t i = 0; i < kOperationCount; ++i)
+            latencies[i].Subtract(iOther.latencies[i]);
+    }
+};
+
+namespace details {
+// Метрики одного потока. Пишет только владелец, поэтому инкремент - это relaxed load + store
+// без блокирующих инструкций; атомарность нужна лишь для чтения из Collect() в другом потоке.
+// Значения только растут: сброс не обнуляет их, а запоминает базу в реестре
+class ThreadMetrics {
+public:
+    void Add(Counter iCounter, uint64_t iValue) noexcept { Bump(counters_[static_cast<size_t>(iCounter)], iValue); }
+
+    void Record(Operation iOperation, uint64_t iNs) noexcept {
+        auto &latency = latencies_[static_cast<size_t>(iOperation)];
+        Bump(latency.buckets[LatencyHistogram::BucketOf(iNs)], 1);
+        Bump(latency.total_ns, iNs);
+    }
+
+    void CollectInto(MetricsSnapshot &oSnapshot) const noexcept {
+        for (size_t i = 0; i < kCounterCount; ++i)
+            oSnapshot.counters[i] += counters_[i].load(std::memory_order_relaxed);
+        for (size_t op = 0; op < kOperationCount; ++op) {
+            const auto &latency = latencies_[op];
+            auto &res = oSnapshot.latencies[op];
+            for (size_t b = 0; b < LatencyHistogram::kBuckets; ++b)
+                res.buckets_[b] += latency.buckets[b].load(std::memory_order_relaxed);
+            res.total_ns_ += latency.total_ns.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct AtomicHistogram {
+        std::array<std::atomic<uint64_t>, LatencyHistogram::kBuckets> buckets{};
+        std::atomic<uint64_t> total_ns{0};
+    };
+
+    static void Bump(std::atomic<uint64_t> &ioValue, uint64_t iDelta) noexcept {
+        ioValue.store(ioValue.load(std::memory_order_relaxed) + iDelta, std::memory_order_relaxed);
+    }
+
+    std::array<std::atomic<uint64_t>, kCounterCount> counters_{};
+    std::array<AtomicHistogram, kOperationCount> latencies_{};
+};
+
+// Реестр метрик живых потоков. Метрики завершившегося потока переносятся в retired_,
+// поэтому пул потоков или короткоживущие потоки не теряют свои счётчики. Reset запоминает
+// текущие суммы как базу, и Collect вычитает её: счётчики потоков никто, кроме владельца,
+// не пишет, поэтому параллельный сброс не гоняется с инкрементом и не теряет его
+class Registry {
+public:
+    static Registry &Instance() {
+        static Registry registry;
+        return registry;
+    }
+
+    void Register(ThreadMetrics *iMetrics) {
+        std::lock_guard lock(mutex_);
+        live_.push_back(iMetrics);
+    }
+    void Unregister(ThreadMetrics *iMetrics) {
+        std::lock_guard lock(mutex_);
+        iMetrics->CollectInto(retired_);
+        std::erase(live_, iMetrics);
+    }
+
+    MetricsSnapshot Collect() const {
+        std::lock_guard lock(mutex_);
+        MetricsSnapshot res = Total();
+        res.Subtract(baseline_);
+        return res;
+    }
+    void Reset() {
+        std::lock_guard lock(mutex_);
+        baseline_ = Total();
+    }
+
+private:
+    // Суммы с запуска программы; вызывается под mutex_
+    MetricsSnapshot Total() const {
+        MetricsSnapshot res = retired_;
+        for (const auto *metrics : live_)
+            metrics->CollectInto(res);
+        return res;
+    }
+
+    mutable std::mutex mutex_;
+    std::vector<ThreadMetrics *> live_;
+    MetricsSnapshot retired_;
+    MetricsSnapshot baseline_;
+};
+
+struct ThreadSlot {
+    ThreadSlot() { Registry::Instance().Register(&metrics); }
+    ~ThreadSlot() { Registry::Instance().Unregister(&metrics); }
+
+    ThreadMetrics metrics;
+};
+
+inline ThreadMetrics &Local() {
+    thread_local ThreadSlot slot;
+    return slot.metrics;
+}
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Operation iOperation) noexcept
+        : operation_(iOperation), start_(std::chrono::steady_clock::now()) {}
+    ScopedTimer(const ScopedTimer &) = delete;
+    ScopedTimer &operator=(const ScopedTimer &) = delete;
+    ~ScopedTimer() {
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_);
+        Local().Record(operation_, static_cast<uint64_t>(ns.count()));
+    }
+
+private:
+    Operation operation_;
+    std::chrono::steady_clock::time_point start_;
+};
+}  // namespace details
+
+// Сумма метрик всех потоков. Без BOOKDB_ENABLE_METRICS - нули
+inline MetricsSnapshot Collect() {
+    if constexpr (kEnabled)
+        return details::Registry::Instance().Collect();
+    return {};
+}
+
+inline void Reset() {
+    if constexpr (kEnabled)
+        details::Registry::Instance().Reset();
+}
+}  // namespace bookdb::metrics
+
+#ifdef BOOKDB_ENABLE_METRICS
+#define BOOKDB_METRIC_ADD(counter, value)                                                                              \
+    ::bookdb::metrics::details::Local().Add(::bookdb::metrics::Counter::counter, static_cast<uint64_t>(value))
+#define BOOKDB_METRIC_TIMER(operation)                                                                                 \
+    const ::bookdb::metrics::details::ScopedTimer bookdbMetricTimer##operation(::bookdb::metrics::Operation::operation)
+#else
+#define BOOKDB_METRIC_ADD(counter, value) static_cast<void>(0)
+#define BOOKDB_METRIC_TIMER(operation) static_cast<void>(0)
+#endif
+
+namespace std {
+// Текстовый формат Prometheus: счётчики и квантили задержек по операциям
+template <>
+struct formatter<bookdb::metrics::MetricsSnapshot, char> {
+    template <typename FormatContext>
+    auto format(const bookdb::metrics::MetricsSnapshot &iSnapshot, FormatContext &fc) const {
+        using namespace bookdb::metrics;
+        for (size_t i = 0; i < kCounterCount; ++i) {
+            const auto counter = static_cast<Counter>(i);
+            format_to(fc.out(), "bookdb_{}_total {}\n", CounterName(counter), iSnapshot.Get(counter));
+        }
+        for (size_t i = 0; i < kOperationCount; ++i) {
+            const auto operation = static_cast<Operation>(i);
+            const auto &latency = iSnapshot.GetLatency(operation);
+            const std::string_view name = OperationName(operation);
+            for (double q : {0.5, 0.9, 0.99})
+                format_to(fc.out(), "bookdb_latency_ns{{op=\"{}\",quantile=\"{}\"}} {}\n", name, q,
+                          latency.GetQuantileNs(q));
+            format_to(fc.out(), "bookdb_latency_ns_sum{{op=\"{}\"}} {}\n", name, latency.GetTotalNs());
+            format_to(fc.out(), "bookdb_latency_ns_count{{op=\"{}\"}} {}\n", name, latency.GetCount());
+        }
+        return fc.out();
+    }
+
+    constexpr auto parse(format_parse_context &ctx) {
+        return ctx.begin();  // Просто игнорируем пользовательский формат
+    }
+};
+}  // namespace std
@@ -0,0 +1,367 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "comparators.hpp"
+#include "concepts.hpp"
+
+namespace bookdb {
+namespace details {
+// Ключ, по которому компаратор упорядочивает книги. Индекс порядка хранит ключ рядом
+// с номером строки и сравнивает ключи, не обращаясь к самим книгам. Column - колонка ключей
+// колоночного хранилища, для остальных контейнеров не определена
+template <typename Cmp>
+struct OrderKey;
+
+template <>
+struct OrderKey<comp::LessByAuthor> {
+    using Key = std::string_view;
+    using Compare = std::less<Key>;
+    static Key Get(const auto &iBook) { return iBook.author; }
+    static auto Column(const auto &iBooks) -> decltype(iBooks.GetAuthors()) { return iBooks.GetAuthors(); }
+};
+
+template <>
+struct OrderKey<comp::LessByGenre> {
+    using Key = Genre;
+    using Compare = std::less<Key>;
+    static Key Get(const auto &iBook) { return iBook.genre; }
+    static auto Column(const auto &iBooks) -> decltype(iBooks.GetGenres()) { return iBooks.GetGenres(); }
+};
+
+template <>
+struct OrderKey<comp::LessByYear> {
+    using Key = int;
+    using Compare = std::less<Key>;
+    static Key Get(const auto &iBook) { return iBook.year; }
+    static auto Column(const auto &iBooks) -> decltype(iBooks.GetYears()) { return iBooks.GetYears(); }
+};
+
+template <>
+struct OrderKey<comp::GreaterByRating> {
+    using Key = double;
+    using Compare = std::greater<Key>;
+    static Key Get(const auto &iBook) { return iBook.rating; }
+    static auto Column(const auto &iBooks) -> decltype(iBooks.GetRatings()) { return iBooks.GetRatings(); }
+};
+
+template <>
+struct OrderKey<comp::LessByRating> {
+    using Key = double;
+    using Compare = std::less<Key>;
+    static Key Get(const auto &iBook) { return iBook.rating; }
+    static auto Column(const auto &iBooks) -> decltype(iBooks.GetRatings()) { return iBooks.GetRatings(); }
+};
+
+template <>
+struct OrderKey<comp::GreaterByReadCount> {
+    using Key = int;
+    using Compare = std::greater<Key>;
+    static Key Get(const auto &iBook) { return iBook.read_count; }
+    static auto Column(const auto &iBooks) -> decltype(iBooks.GetReadCounts()) { return iBooks.GetReadCounts(); }
+};
+
+template <>
+struct OrderKey<comp::LessByPopularity> {
+    using Key = int;
+    using Compare = std::less<Key>;
+    static Key Get(const auto &iBook) { return iBook.read_count; }
+    static auto Column(const auto &iBooks) -> decltype(iBooks.GetReadCounts()) { return iBooks.GetReadCounts(); }
+};
+}  // namespace details
+
+template <typename Cmp>
+concept OrderIndexable = requires { typename details::OrderKey<Cmp>::Key; };
+
+// Перестановка строк базы в порядке компаратора Cmp. Книги с равными ключами идут
+// в порядке вставки, как после std::stable_sort. Устроен как SortedKeyIndex: новые
+// строки попадают в небольшую отсортированную дельту, которая сливается с основным
+// массивом, когда вырастает до ~sqrt(N); обход по порядку сливает обе части на лету.
+// Удаления из основного массива так же копятся в отсортированном списке до слияния
+template <OrderIndexable Cmp>
+class OrderIndex {
+public:
+    using Key = typename details::OrderKey<Cmp>::Key;
+    using Compare = typename details::OrderKey<Cmp>::Compare;
+    using Entry = std::pair<Key, RowId>;
+
+    OrderIndex() = default;
+
+    // Строит индекс по всем книгам контейнера сразу, без дельты
+    template <typename Books>
+    explicit OrderIndex(const Books &iBooks) : OrderIndex(iBooks, [](RowId) { return false; }) {}
+
+    // Строки, для которых iSkip(row) истинно (удалённые), в индекс не попадают
+    template <typename Books, typename Skip>
+    OrderIndex(const Books &iBooks, const Skip &iSkip) {
+        main_.reserve(iBooks.size());
+        RowId row = 0;
+        for (const auto &book : iBooks) {
+            if (!iSkip(row))
+                main_.emplace_back(details::OrderKey<Cmp>::Get(book), row);
+            ++row;
+        }
+        std::stable_sort(main_.begin(), main_.end(), EntryLess{});
+    }
+
+    // Строки добавляются по возрастанию номеров, как при вставке в базу
+    template <typename B>
+    void Insert(const B &iBook, RowId iRow) {
+        const Entry entry{details::OrderKey<Cmp>::Get(iBook), iRow};
+        delta_.insert(std::upper_bound(delta_.begin(), delta_.end(), entry, EntryLess{}), entry);
+        if (delta_.size() > MaxDeltaSize())
+            Merge();
+    }
+
+    void Erase(const Key &iKey, RowId iRow) {
+        const Entry entry{iKey, iRow};
+        auto it = std::lower_bound(delta_.begin(), delta_.end(), entry, EntryLess{});
+        if (it != delta_.end() && *it == entry) {
+            delta_.erase(it);
+            return;
+        }
+        erased_.insert(std::upper_bound(erased_.begin(), erased_.end(), entry, EntryLess{}), entry);
+        if (erased_.size() > MaxDeltaSize())
+            Merge();
+    }
+
+    template <typename B>
+        requires(!std::is_convertible_v<const B &, Key>)
+    void Erase(const B &iBook, RowId iRow) {
+        Erase(details::OrderKey<Cmp>::Get(iBook), iRow);
+    }
+
+    // Ключ книги iRow изменился на месте
+    template <typename B>
+    void Update(const B &iBefore, const B &iAfter, RowId iRow) {
+        const Key before = details::OrderKey<Cmp>::Get(iBefore);
+        if (before == details::OrderKey<Cmp>::Get(iAfter))
+            return;
+        Erase(before, iRow);
+        Insert(iAfter, iRow);
+    }
+
+    void Clear() noexcept {
+        main_.clear();
+        delta_.clear();
+        erased_.clear();
+    }
+
+    size_t size() const noexcept { return main_.size() + delta_.size() - erased_.size(); }
+
+    // iFunc(RowId) для всех строк по порядку; если iFunc возвращает bool, false прекращает обход
+    template <typename F>
+    void ForEach(F &&iFunc) const {
+        Walk({main_.begin(), main_.end()}, {delta_.begin(), delta_.end()}, {erased_.begin(), erased_.end()}, iFunc);
+    }
+
+    // Первые iCount строк по порядку
+    std::vector<RowId> First(size_t iCount) const {
+        std::vector<RowId> res;
+        res.reserve(std::min(iCount, size()));
+        if (iCount)
+            ForEach([&](RowId row) {
+                res.push_back(row);
+                return res.size() < iCount;
+            });
+        return res;
+    }
+
+    std::vector<RowId> Rows() const { return First(size()); }
+
+    // Строки с ключом между iFrom и iTo включительно, оба конца в порядке индекса:
+    // для GreaterByRating Between(5., 4.) выбирает рейтинги от 5 до 4
+    std::vector<RowId> Between(const Key &iFrom, const Key &iTo) const {
+        std::vector<RowId> res;
+        auto range = [&](const std::vector<Entry> &part) {
+            auto first = std::lower_bound(part.begin(), part.end(), iFrom, EntryLess{});
+            return std::pair{first, std::upper_bound(first, part.end(), iTo, EntryLess{})};
+        };
+        Walk(range(main_), range(delta_), range(erased_), [&res](RowId row) { res.push_back(row); });
+        return res;
+    }
+
+private:
+    using EntryIt = typename std::vector<Entry>::const_iterator;
+
+    // Порядок по ключу, при равных ключах - по номеру строки
+    struct EntryLess {
+        bool operator()(const Entry &lhv, const Entry &rhv) const {
+            if (Compare{}(lhv.first, rhv.first))
+                return true;
+            if (Compare{}(rhv.first, lhv.first))
+                return false;
+            return lhv.second < rhv.second;
+        }
+        bool operator()(const Entry &lhv, const Key &rhv) const { return Compare{}(lhv.first, rhv); }
+        bool operator()(const Key &lhv, const Entry &rhv) const { return Compare{}(lhv, rhv.first); }
+    };
+
+    static constexpr size_t kMinDeltaSize = 1024;
+
+    size_t MaxDeltaSize() const noexcept {
+        return std::max(kMinDeltaSize, static_cast<size_t>(std::sqrt(static_cast<double>(main_.size()))));
+    }
+
+    void Merge() {
+        if (!erased_.empty()) {
+            std::vector<Entry> kept;
+            kept.reserve(main_.size() - erased_.size());
+            std::set_difference(main_.begin(), main_.end(), erased_.begin(), erased_.end(), std::back_inserter(kept),
+                                EntryLess{});
+            main_ = std::move(kept);
+            erased_.clear();
+        }
+        const auto middle = static_cast<std::ptrdiff_t>(main_.size());
+        main_.insert(main_.end(), delta_.begin(), delta_.end());
+        std::inplace_merge(main_.begin(), main_.begin() + middle, main_.end(), EntryLess{});
+        delta_.clear();
+    }
+
+    using EntryRange = std::pair<EntryIt, EntryIt>;
+
+    // Слияние основного массива и дельты без записей из списка удалённых
+    template <typename F>
+    static void Walk(EntryRange iMain, EntryRange iDelta, EntryRange iErased, F &&iFunc) {
+        auto &[main, mainEnd] = iMain;
+        auto &[delta, deltaEnd] = iDelta;
+        auto &[erased, erasedEnd] = iErased;
+        while (main != mainEnd || delta != deltaEnd) {
+            const bool fromDelta = main == mainEnd || (delta != deltaEnd && EntryLess{}(*delta, *main));
+            if (!fromDelta) {
+                while (erased != erasedEnd && EntryLess{}(*erased, *main))
+                    ++erased;
+                if (erased != erasedEnd && *erased == *main) {
+                    ++erased;
+                    ++main;
+                    continue;
+                }
+            }
+            const RowId row = (fromDelta ? delta++ : main++)->second;
+            if constexpr (std::is_same_v<std::invoke_result_t<F &, RowId>, bool>) {
+                if (!iFunc(row))
+                    return;
+            } else {
+                iFunc(row);
+            }
+        }
+    }
+
+    std::vector<Entry> main_;
+    std::vector<Entry> delta_;
+    std::vector<Entry> erased_;
+};
+
+// Набор индексов порядка базы: каждый поддерживаемый компаратор можно включить отдельно
+class OrderIndexes {
+public:
+    template <OrderIndexable Cmp, typename Books, typename Skip>
+    void Enable(const Books &iBooks, const Skip &iSkip) {
+        std::get<std::optional<OrderIndex<Cmp>>>(indexes_).emplace(iBooks, iSkip);
+    }
+
+    template <OrderIndexable Cmp>
+    void Disable() noexcept {
+        std::get<std::optional<OrderIndex<Cmp>>>(indexes_).reset();
+    }
+
+    template <OrderIndexable Cmp>
+    const OrderIndex<Cmp> *Get() const noexcept {
+        const auto &index = std::get<std::optional<OrderIndex<Cmp>>>(indexes_);
+        return index ? &*index : nullptr;
+    }
+
+    template <typename B>
+    void Insert(const B &iBook, RowId iRow) {
+        std::apply([&](auto &...index) { ((index ? index->Insert(iBook, iRow) : void()), ...); }, indexes_);
+    }
+
+    template <typename B>
+    void Erase(const B &iBook, RowId iRow) {
+        std::apply([&](auto &...index) { ((index ? index->Erase(iBook, iRow) : void()), ...); }, indexes_);
+    }
+
+    void Clear() noexcept {
+        std::apply([](auto &...index) { ((index ? index->Clear() : void()), ...); }, indexes_);
+    }
+
+    template <typename B>
+    void Update(const B &iBefore, const B &iAfter, RowId iRow) {
+        std::apply([&](auto &...index) { ((index ? index->Update(iBefore, iAfter, iRow) : void()), ...); }, indexes_);
+    }
+
+    // Включает те же индексы, что в iOther (новые строятся по iBooks без строк iSkip), и выключает остальные
+    template <typename Books, typename Skip>
+    void MatchLayout(const OrderIndexes &iOther, const Books &iBooks, const Skip &iSkip) {
+        [&]<size_t... Is>(std::index_sequence<Is...>) {
+            (MatchOne(std::get<Is>(indexes_), std::get<Is>(iOther.indexes_), iBooks, iSkip), ...);
+        }(std::make_index_sequence<std::tuple_size_v<decltype(indexes_)>>{});
+    }
+
+    // Заново строит включённые индексы, например после перестановки книг
+    template <typename Books>
+    void Rebuild(const Books &iBooks) {
+        std::apply([&](auto &...index) { ((index ? void(index.emplace(iBooks)) : void()), ...); }, indexes_);
+    }
+
+private:
+    template <typename Index, typename Books, typename Skip>
+    static void MatchOne(std::optional<Index> &ioIndex, const std::optional<Index> &iOther, const Books &iBooks,
+                         const Skip &iSkip) {
+        if (!iOther)
+            ioIndex.reset();
+        else if (!ioIndex)
+            ioIndex.emplace(iBooks, iSkip);
+    }
+
+    std::tuple<std::optional<OrderIndex<comp::LessByAuthor>>, std::optional<OrderIndex<comp::LessByGenre>>,
+               std::optional<OrderIndex<comp::LessByYear>>, std::optional<OrderIndex<comp::GreaterByRating>>,
+               std::optional<OrderIndex<comp::LessByRating>>, std::optional<OrderIndex<comp::GreaterByReadCount>>,
+               std::optional<OrderIndex<comp::LessByPopularity>>>
+        indexes_;
+};
+
+// Номера строк базы в порядке компаратора, не переставляя сами книги. С включённым индексом
+// порядка для Cmp ответ берётся из него, иначе сортируются номера строк. Равные книги идут
+// в порядке вставки, поэтому оба пути дают одинаковый результат. Удалённых строк нет ни в индексе,
+// ни в ответе
+template <typename Db, typename Cmp>
+std::vector<RowId> orderedBookIds(const Db &iDb, const Cmp &iCmp, size_t iLimit = std::numeric_limits<size_t>::max()) {
+    if constexpr (OrderIndexable<Cmp>) {
+        if (const auto *index = iDb.template GetOrderIndex<Cmp>())
+            return index->First(iLimit);
+    }
+    const auto &books = iDb.GetBooks();
+    std::vector<RowId> res;
+    res.reserve(iDb.GetLiveCount());
+    for (RowId row = 0; row < books.size(); ++row)
+        if (!iDb.IsErased(row))
+            res.push_back(row);
+    auto less = [&](RowId lhv, RowId rhv) {
+        if (iCmp(books[lhv], books[rhv]))
+            return true;
+        if (iCmp(books[rhv], books[lhv]))
+            return false;
+        return lhv < rhv;
+    };
+    if (iLimit < res.size()) {
+        std::partial_sort(res.begin(), res.begin() + iLimit, res.end(), less);
+        res.resize(iLimit);
+    } else {
+        std::sort(res.begin(), res.end(), less);
+    }
+    return res;
+}
+}  // namespace bookdb
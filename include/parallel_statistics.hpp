@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <iterator>
+#include <vector>
+
+#include "book_database.hpp"
+#include "metrics.hpp"
+#include "statsistics.hpp"
+#include "thread_pool.hpp"
+
+// Параллельные версии функций из statsistics.hpp. Диапазон делится на непрерывные части,
+// каждая часть считает свои частичные агрегаты без синхронизации, затем они сливаются
+// в порядке номеров частей, поэтому при одной и той же степени параллелизма результат
+// воспроизводим от запуска к запуску. При удалённых строках считают последовательные версии
+namespace bookdb {
+
+// Части берут свои строки по смещению от начала, поэтому нужен контейнер с произвольным доступом.
+// Каждая часть ведёт плотный массив счётчиков по номерам авторов, слияние - поэлементное сложение
+template <BookContainerLike T>
+    requires std::random_access_iterator<typename T::const_iterator>
+std::vector<size_t> buildAuthorHistogramDenseParallel(const BookDatabase<T> &iCont, const Parallelism &iPar = {}) {
+    if (iCont.GetErasedCount())
+        return buildAuthorHistogramDense(iCont);
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    const size_t authors = iCont.GetAuthors().size();
+    std::vector<std::vector<size_t>> partials(ParallelPartCount(iCont.size(), iPar));
+    ParallelFor(iCont.size(), iPar, [&](size_t part, size_t begin, size_t end) {
+        auto &local = partials[part];
+        local.assign(authors, 0);
+        if constexpr (ColumnarBookContainerLike<T>) {
+            for (AuthorId id : iCont.GetBooks().GetAuthorIds().subspan(begin, end - begin))
+                ++local[id];
+        } else {
+            for (auto it = iCont.begin() + begin, last = iCont.begin() + end; it != last; ++it)
+                ++local[it->author_id];
+        }
+    });
+
+    std::vector<size_t> res = std::move(partials.front());
+    for (size_t part = 1; part < partials.size(); ++part)
+        for (size_t id = 0; id < authors; ++id)
+            res[id] += partials[part][id];
+    return res;
+}
+
+template <BookContainerLike T, typename Comparator = TransparentStringLess>
+    requires std::random_access_iterator<typename T::const_iterator>
+auto buildAuthorHistogramFlatParallel(const BookDatabase<T> &iCont, const Parallelism &iPar = {}) {
+    return details::MakeAuthorHistogram<Comparator>(iCont.GetAuthors(), buildAuthorHistogramDenseParallel(iCont, iPar));
+}
+
+template <ConstBookIterator T, typename Comparator = std::less<Genre>>
+    requires std::random_access_iterator<T>
+auto calculateGenreRatingsParallel(T iItBegin, T iItEnd, const Parallelism &iPar = {}) {
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    const auto size = static_cast<size_t>(std::distance(iItBegin, iItEnd));
+    std::vector<details::GenrePartial> partials(ParallelPartCount(size, iPar));
+    ParallelFor(size, iPar, [&](size_t part, size_t begin, size_t end) {
+        auto &local = partials[part];
+        for (auto it = iItBegin + begin, last = iItBegin + end; it != last; ++it) {
+            auto &[totalRating, count] = local[details::GenreSlot(it->genre)];
+            ++count;
+            totalRating += it->rating;
+        }
+    });
+
+    details::GenrePartial tmp{};
+    for (const auto &local : partials) {
+        for (size_t i = 0; i < tmp.size(); ++i) {
+            tmp[i].first += local[i].first;
+            tmp[i].second += local[i].second;
+        }
+    }
+
+    return details::MakeGenreRatings<Comparator>(tmp);
+}
+
+template <BookContainerLike T>
+    requires std::random_access_iterator<typename T::const_iterator>
+double calculateAverageRatingParallel(const BookDatabase<T> &iCont, const Parallelism &iPar = {}) {
+    if (iCont.GetErasedCount())
+        return calculateAverageRating(iCont);
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    std::vector<double> partials(ParallelPartCount(iCont.size(), iPar));
+    ParallelFor(iCont.size(), iPar, [&](size_t part, size_t begin, size_t end) {
+        double sum = 0.;
+        if constexpr (ColumnarBookContainerLike<T>) {
+            const auto ratings = iCont.GetBooks().GetRatings().subspan(begin, end - begin);
+            for (double r : ratings)
+                sum += r;
+        } else {
+            for (auto it = iCont.begin() + begin, last = iCont.begin() + end; it != last; ++it)
+                sum += it->rating;
+        }
+        partials[part] = sum;
+    });
+
+    double sum = 0.;
+    for (double partial : partials)
+        sum += partial;
+    return !iCont.empty() ? sum / iCont.size() : 0.0;
+}
+}  // namespace bookdb
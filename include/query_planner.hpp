@@ -0,0 +1,366 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "bitmap_filter.hpp"
+#include "book_database.hpp"
+#include "filters.hpp"
+#include "metrics.hpp"
+#include "secondary_index.hpp"
+#include "selection_bitmap.hpp"
+#include "zone_map.hpp"
+
+namespace bookdb {
+namespace details {
+// Условная стоимость проверки одной строки. Сравнение числа - единица, сравнение строки дороже,
+// про произвольную лямбду ничего не известно, поэтому она считается самой дорогой
+template <typename P>
+inline constexpr double kRowCost = 16.;
+template <>
+inline constexpr double kRowCost<pred::YearBetween> = 1.;
+template <>
+inline constexpr double kRowCost<pred::RatingAbove> = 1.;
+template <>
+inline constexpr double kRowCost<pred::GenreIs> = 1.;
+template <>
+inline constexpr double kRowCost<pred::AuthorIs> = 4.;
+template <typename... Ps>
+inline constexpr double kRowCost<pred::AllOf<Ps...>> = (kRowCost<Ps> + ...);
+template <typename... Ps>
+inline constexpr double kRowCost<pred::AnyOf<Ps...>> = (kRowCost<Ps> + ...);
+
+// Предикат, на который SecondaryIndexes::Lookup даёт ответ
+template <typename P>
+inline constexpr bool IsIndexable = std::same_as<P, pred::YearBetween> || std::same_as<P, pred::RatingAbove> ||
+                                    std::same_as<P, pred::GenreIs> || std::same_as<P, pred::AuthorIs>;
+template <typename... Ps>
+inline constexpr bool IsIndexable<pred::AllOf<Ps...>> = (IsIndexable<Ps> || ...);
+template <typename... Ps>
+inline constexpr bool IsIndexable<pred::AnyOf<Ps...>> = (IsIndexable<Ps> && ...);
+
+// Без индексов селективность оценивается грубо, из типичного распределения каталога
+inline constexpr double kOpaqueSelectivity = 0.5;
+inline constexpr double kAuthorSelectivity = 0.01;
+inline constexpr double kYearSpan = 200.;
+inline constexpr double kMaxRating = 5.;
+
+struct PlanContext {
+    const SecondaryIndexes *indexes = nullptr;
+    size_t rows = 0;
+
+    double Fraction(size_t iCount) const noexcept { return rows ? static_cast<double>(iCount) / rows : 0.; }
+};
+
+template <typename P>
+double EstimateSelectivity(const P &iPred, const PlanContext &iCtx) {
+    const auto *idx = iCtx.indexes;
+    if constexpr (std::same_as<P, pred::GenreIs>) {
+        return idx ? iCtx.Fraction(idx->ByGenre(iPred.genre).size()) : 1. / kGenreCount;
+    } else if constexpr (std::same_as<P, pred::AuthorIs>) {
+        return idx ? iCtx.Fraction(idx->ByAuthor(iPred.author).size()) : kAuthorSelectivity;
+    } else if constexpr (std::same_as<P, pred::YearBetween>) {
+        return idx ? iCtx.Fraction(idx->ByYear().CountBetween(iPred.start, iPred.end))
+                   : std::clamp((iPred.end - iPred.start + 1) / kYearSpan, 0., 1.);
+    } else if constexpr (std::same_as<P, pred::RatingAbove>) {
+        return idx ? iCtx.Fraction(idx->ByRating().CountAbove(iPred.min_rating))
+                   : std::clamp((kMaxRating - iPred.min_rating) / kMaxRating, 0., 1.);
+    } else {
+        return kOpaqueSelectivity;
+    }
+}
+}  // namespace details
+
+// Узел плана - типизированное дерево, повторяющее дерево предикатов all_of/any_of.
+// Лист хранит сам предикат и его оценки
+template <typename P>
+class PlanNode {
+public:
+    PlanNode(const P &iPred, const details::PlanContext &iCtx)
+        : pred_(iPred), selectivity_(details::EstimateSelectivity(iPred, iCtx)) {}
+
+    double GetSelectivity() const noexcept { return selectivity_; }
+    static constexpr double GetCost() noexcept { return details::kRowCost<P>; }
+    const P &GetPredicate() const noexcept { return pred_; }
+
+    template <typename B>
+    bool operator()(const B &iBook) const {
+        return pred_(iBook);
+    }
+
+    template <typename Books>
+    SelectionBitmap Scan(const Books &iBooks) const {
+        return selectBooks(iBooks, pred_);
+    }
+
+private:
+    P pred_;
+    double selectivity_;
+};
+
+namespace details {
+// Общая часть узлов all_of/any_of: дети и порядок их вычисления, выбранный планировщиком
+template <bool IsConjunction, typename... Ps>
+class CompositePlanNode {
+public:
+    using Predicate = std::conditional_t<IsConjunction, pred::AllOf<Ps...>, pred::AnyOf<Ps...>>;
+    static constexpr size_t kArity = sizeof...(Ps);
+
+    CompositePlanNode(const Predicate &iPred, const PlanContext &iCtx)
+        : pred_(iPred), children_(std::apply([&iCtx](const auto &...p) { return std::tuple{PlanNode(p, iCtx)...}; },
+                                             iPred.preds)) {
+        std::array<double, kArity> ranks{};
+        std::apply(
+            [&](const auto &...child) {
+                size_t i = 0;
+                ((ranks[i++] = Rank(child.GetSelectivity(), child.GetCost())), ...);
+                double combined = IsConjunction ? 1. : 0.;
+                ((combined = IsConjunction ? combined * child.GetSelectivity()
+                                           : 1. - (1. - combined) * (1. - child.GetSelectivity())),
+                 ...);
+                selectivity_ = combined;
+            },
+            children_);
+        std::iota(order_.begin(), order_.end(), size_t{0});
+        std::stable_sort(order_.begin(), order_.end(), [&ranks](size_t l, size_t r) { return ranks[l] < ranks[r]; });
+    }
+
+    double GetSelectivity() const noexcept { return selectivity_; }
+    static constexpr double GetCost() noexcept { return kRowCost<Predicate>; }
+    const Predicate &GetPredicate() const noexcept { return pred_; }
+    const std::array<size_t, kArity> &GetOrder() const noexcept { return order_; }
+
+    template <size_t I>
+    const auto &GetChild() const noexcept {
+        return std::get<I>(children_);
+    }
+
+    // Построчная проверка с коротким замыканием в выбранном порядке. iSkip - ребёнок,
+    // который уже гарантированно выполнен (например, отвечен индексом)
+    template <typename B>
+    bool operator()(const B &iBook, size_t iSkip = kArity) const {
+        for (size_t i : order_) {
+            if (i == iSkip)
+                continue;
+            if (EvalChild(i, iBook) != IsConjunction)
+                return !IsConjunction;
+        }
+        return IsConjunction;
+    }
+
+    template <typename Books>
+    SelectionBitmap Scan(const Books &iBooks) const {
+        const size_t rows = iBooks.size();
+        SelectionBitmap res(rows, IsConjunction);
+        for (size_t i : order_) {
+            const size_t selected = res.Count();
+            if constexpr (IsConjunction) {
+                if (selected == 0)
+                    break;
+                // Когда выживших строк мало, дешевле проверить только их, чем считать ядро по всей колонке
+                if (selected * kRefineRatio < rows)
+                    res.ForEachSet([&](size_t row) {
+                        if (!EvalChild(i, iBooks[row]))
+                            res.Reset(row);
+                    });
+                else
+                    res &= ScanChild(i, iBooks);
+            } else {
+                if (selected == rows)
+                    break;
+                res |= ScanChild(i, iBooks);
+            }
+        }
+        return res;
+    }
+
+    std::optional<IndexLookup> LookupChild(size_t i, const SecondaryIndexes &iIndexes) const {
+        return Dispatch<std::optional<IndexLookup>>(i, [&](const auto &child) -> std::optional<IndexLookup> {
+            if constexpr (IsIndexable<std::remove_cvref_t<decltype(child.GetPredicate())>>)
+                return iIndexes.Lookup(child.GetPredicate());
+            else
+                return std::nullopt;
+        });
+    }
+
+    bool IsChildIndexable(size_t i) const {
+        return Dispatch<bool>(
+            i, [](const auto &child) { return IsIndexable<std::remove_cvref_t<decltype(child.GetPredicate())>>; });
+    }
+
+    double GetChildSelectivity(size_t i) const {
+        return Dispatch<double>(i, [](const auto &child) { return child.GetSelectivity(); });
+    }
+
+private:
+    static constexpr size_t kRefineRatio = 32;
+
+    // Для конъюнкции первым выгоднее проверять то, что дёшево и чаще отсекает строку,
+    // для дизъюнкции - то, что дёшево и чаще выполняется
+    static double Rank(double iSelectivity, double iCost) noexcept {
+        const double hit = IsConjunction ? 1. - iSelectivity : iSelectivity;
+        return hit > 0. ? iCost / hit : std::numeric_limits<double>::infinity();
+    }
+
+    template <typename R, typename F>
+    R Dispatch(size_t i, F &&iFunc) const {
+        return [&]<size_t... Is>(std::index_sequence<Is...>) {
+            R res{};
+            ((i == Is ? void(res = iFunc(std::get<Is>(children_))) : void()), ...);
+            return res;
+        }(std::index_sequence_for<Ps...>{});
+    }
+
+    template <typename B>
+    bool EvalChild(size_t i, const B &iBook) const {
+        return Dispatch<bool>(i, [&iBook](const auto &child) { return child(iBook); });
+    }
+
+    template <typename Books>
+    SelectionBitmap ScanChild(size_t i, const Books &iBooks) const {
+        return Dispatch<SelectionBitmap>(i, [&iBooks](const auto &child) { return child.Scan(iBooks); });
+    }
+
+    Predicate pred_;
+    std::tuple<PlanNode<Ps>...> children_;
+    std::array<size_t, kArity> order_{};
+    double selectivity_ = 1.;
+};
+}  // namespace details
+
+template <typename... Ps>
+class PlanNode<pred::AllOf<Ps...>> : public details::CompositePlanNode<true, Ps...> {
+    using details::CompositePlanNode<true, Ps...>::CompositePlanNode;
+};
+
+template <typename... Ps>
+class PlanNode<pred::AnyOf<Ps...>> : public details::CompositePlanNode<false, Ps...> {
+    using details::CompositePlanNode<false, Ps...>::CompositePlanNode;
+};
+
+enum class AccessPath { FullScan, Index };
+
+// План запроса: переупорядоченное дерево предикатов и способ доступа к строкам.
+// Индекс выбирается, только если он отсекает почти все строки - иначе векторный
+// проход по колонке быстрее случайного доступа по спискам строк
+template <typename P>
+class QueryPlan {
+public:
+    static constexpr double kIndexSelectivityThreshold = 0.02;
+
+    QueryPlan(const P &iPred, const details::PlanContext &iCtx) : root_(iPred, iCtx) {
+        if (!iCtx.indexes)
+            return;
+        if constexpr (details::IsAllOf<P>) {
+            // Для all_of индексом отвечает самый селективный индексируемый конъюнкт, остальные проверяются построчно
+            for (size_t i : root_.GetOrder()) {
+                if (!root_.IsChildIndexable(i))
+                    continue;
+                const double sel = root_.GetChildSelectivity(i);
+                if (sel < kIndexSelectivityThreshold && (index_child_ == kNoChild || sel < index_selectivity_)) {
+                    index_child_ = i;
+                    index_selectivity_ = sel;
+                }
+            }
+            if (index_child_ != kNoChild)
+                access_ = AccessPath::Index;
+        } else if constexpr (details::IsIndexable<P>) {
+            if (root_.GetSelectivity() < kIndexSelectivityThreshold)
+                access_ = AccessPath::Index;
+        }
+    }
+
+    AccessPath GetAccessPath() const noexcept { return access_; }
+    double GetEstimatedSelectivity() const noexcept { return root_.GetSelectivity(); }
+    const PlanNode<P> &GetRoot() const noexcept { return root_; }
+
+    // План можно использовать как обычный предикат, например в filterBooks(begin, end, plan)
+    template <typename B>
+    bool operator()(const B &iBook) const {
+        return root_(iBook);
+    }
+
+    template <BookContainerLike T>
+    std::vector<RowId> Execute(const BookDatabase<T> &iDb) const {
+        BOOKDB_METRIC_TIMER(Filter);
+        BOOKDB_METRIC_ADD(FilterCalls, 1);
+        std::vector<RowId> res = Run(iDb);
+        BOOKDB_METRIC_ADD(RowsSelected, res.size());
+        return res;
+    }
+
+private:
+    static constexpr size_t kNoChild = std::numeric_limits<size_t>::max();
+
+    // Просмотренными считаются строки, которые проверялись построчно: кандидаты из индекса,
+    // строки блоков, не отброшенных сводками, или вся база
+    template <BookContainerLike T>
+    std::vector<RowId> Run(const BookDatabase<T> &iDb) const {
+        const auto &books = iDb.GetBooks();
+        if (access_ == AccessPath::Index) {
+            const auto *indexes = iDb.GetIndexes();
+            if constexpr (details::IsAllOf<P>) {
+                auto hit = root_.LookupChild(index_child_, *indexes);
+                const size_t skip = hit->exact ? index_child_ : PlanNode<P>::kArity;
+                BOOKDB_METRIC_ADD(RowsScanned, hit->rows.size());
+                std::erase_if(hit->rows, [&](RowId row) { return iDb.IsErased(row) || !root_(books[row], skip); });
+                return std::move(hit->rows);
+            } else if constexpr (details::IsIndexable<P>) {
+                auto hit = indexes->Lookup(root_.GetPredicate());
+                BOOKDB_METRIC_ADD(RowsScanned, hit->rows.size());
+                if (!hit->exact || iDb.GetErasedCount())
+                    std::erase_if(hit->rows, [&](RowId row) { return iDb.IsErased(row) || !root_(books[row]); });
+                return std::move(hit->rows);
+            }
+        }
+        if (const ZoneMap *zones = iDb.GetZoneMap()) {
+            size_t scanned = 0;
+            if (auto zoned = details::SelectZoned(books, *zones, root_.GetPredicate(), root_, scanned)) {
+                BOOKDB_METRIC_ADD(RowsScanned, scanned);
+                return zoned->AndNot(iDb.GetTombstones()).ToIndices();
+            }
+        }
+        BOOKDB_METRIC_ADD(RowsScanned, books.size());
+        return root_.Scan(books).AndNot(iDb.GetTombstones()).ToIndices();
+    }
+
+    PlanNode<P> root_;
+    AccessPath access_ = AccessPath::FullScan;
+    size_t index_child_ = kNoChild;
+    double index_selectivity_ = 1.;
+};
+
+// Строит план с учётом вторичных индексов базы, если они включены
+template <BookContainerLike T, typename P>
+QueryPlan<P> planQuery(const BookDatabase<T> &iDb, const P &iPred) {
+    return QueryPlan<P>(iPred, details::PlanContext{iDb.GetIndexes(), iDb.size()});
+}
+
+// Выборка по базе идёт через планировщик: он сам решает, отвечать ли индексом или проходом по колонкам
+template <BookContainerLike T, typename P>
+std::vector<RowId> filterBookIds(const BookDatabase<T> &iDb, const P &iPred) {
+    return planQuery(iDb, iPred).Execute(iDb);
+}
+
+template <BookContainerLike T, typename P>
+    requires std::is_lvalue_reference_v<typename T::reference>
+std::vector<std::reference_wrapper<const Book>> filterBooks(const BookDatabase<T> &iDb, const P &iPred) {
+    const auto rows = filterBookIds(iDb, iPred);
+
+    std::vector<std::reference_wrapper<const Book>> result;
+    result.reserve(rows.size());
+    for (RowId row : rows)
+        result.emplace_back(iDb.GetBooks()[row]);
+    return result;
+}
+}  // namespace bookdb
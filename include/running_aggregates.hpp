@@ -0,0 +1,74 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+
+namespace bookdb {
+
+// Агрегаты, которые BookDatabase поддерживает при каждой вставке и удалении, чтобы частые запросы
+// средних и счётчиков не пересчитывали всю базу. Все чтения - O(1)
+class RunningAggregates {
+public:
+    template <typename B>
+    void Insert(const B &iBook) {
+        auto &[totalRating, count] = genres_[details::GenreSlot(iBook.genre)];
+        totalRating += iBook.rating;
+        ++count;
+        // Книги базы всегда имеют номер автора, номера плотные - массив растёт не больше чем на один
+        if (iBook.author_id >= authors_.size())
+            authors_.resize(iBook.author_id + 1);
+        ++authors_[iBook.author_id];
+        rating_sum_ += iBook.rating;
+        read_count_sum_ += iBook.read_count;
+        ++books_;
+    }
+
+    // Обратная операция к Insert для удалённой книги
+    template <typename B>
+    void Erase(const B &iBook) {
+        auto &[totalRating, count] = genres_[details::GenreSlot(iBook.genre)];
+        totalRating -= iBook.rating;
+        --count;
+        --authors_[iBook.author_id];
+        rating_sum_ -= iBook.rating;
+        read_count_sum_ -= iBook.read_count;
+        --books_;
+    }
+
+    void Clear() noexcept {
+        genres_ = {};
+        authors_.clear();
+        rating_sum_ = 0.;
+        read_count_sum_ = 0;
+        books_ = 0;
+    }
+
+    size_t GetBookCount() const noexcept { return books_; }
+    double GetAverageRating() const noexcept { return books_ ? rating_sum_ / books_ : 0.; }
+    long long GetTotalReadCount() const noexcept { return read_count_sum_; }
+
+    double GetGenreRating(Genre iGenre) const noexcept {
+        const auto &[totalRating, count] = genres_[details::GenreSlot(iGenre)];
+        return count ? totalRating / count : 0.;
+    }
+    size_t GetGenreCount(Genre iGenre) const noexcept { return genres_[details::GenreSlot(iGenre)].second; }
+
+    // Номер автора - из словаря базы (BookDatabase::GetAuthors().Find)
+    size_t GetAuthorCount(AuthorId iAuthor) const noexcept {
+        return iAuthor < authors_.size() ? authors_[iAuthor] : 0;
+    }
+    // Число книг каждого автора, индекс - номер автора
+    std::span<const size_t> GetAuthorCounts() const noexcept { return authors_; }
+
+private:
+    std::array<std::pair<double, size_t>, kGenreCount> genres_{};
+    std::vector<size_t> authors_;
+    double rating_sum_ = 0.;
+    long long read_count_sum_ = 0;
+    size_t books_ = 0;
+};
+}  // namespace bookdb
@@ -0,0 +1,265 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <flat_map>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "concepts.hpp"
+#include "filters.hpp"
+#include "heterogeneous_lookup.hpp"
+
+namespace bookdb {
+
+// Упорядоченный по ключу индекс (ключ, номер строки). Новые записи попадают в небольшую
+// отсортированную дельту, которая сливается с основным массивом, когда вырастает до ~sqrt(N).
+// Так вставка стоит амортизированно O(sqrt(N)), а запрос диапазона - два бинарных поиска.
+// Удаление записи из основного массива так же откладывается: она попадает в отсортированный
+// список удалённых, который вычитается при запросах и применяется при слиянии
+template <typename Key>
+class SortedKeyIndex {
+public:
+    using Entry = std::pair<Key, RowId>;
+
+    void Insert(Key iKey, RowId iRow) {
+        const Entry entry{iKey, iRow};
+        delta_.insert(std::upper_bound(delta_.begin(), delta_.end(), entry), entry);
+        if (delta_.size() > MaxDeltaSize())
+            Merge();
+    }
+
+    void Erase(Key iKey, RowId iRow) {
+        const Entry entry{iKey, iRow};
+        if (auto it = std::lower_bound(delta_.begin(), delta_.end(), entry); it != delta_.end() && *it == entry) {
+            delta_.erase(it);
+            return;
+        }
+        erased_.insert(std::upper_bound(erased_.begin(), erased_.end(), entry), entry);
+        if (erased_.size() > MaxDeltaSize())
+            Merge();
+    }
+
+    void Clear() noexcept {
+        main_.clear();
+        delta_.clear();
+        erased_.clear();
+    }
+
+    size_t size() const noexcept { return main_.size() + delta_.size() - erased_.size(); }
+
+    // Строки с ключом из [iLow, iHigh]
+    std::vector<RowId> Between(const Key &iLow, const Key &iHigh) const {
+        return Collect([&](const std::vector<Entry> &part) {
+            auto first = std::lower_bound(part.begin(), part.end(), iLow, KeyLess{});
+            auto last = std::upper_bound(first, part.end(), iHigh, KeyLess{});
+            return std::pair{first, last};
+        });
+    }
+
+    // Строки с ключом строго больше iLow
+    std::vector<RowId> Above(const Key &iLow) const {
+        return Collect([&](const std::vector<Entry> &part) {
+            return std::pair{std::upper_bound(part.begin(), part.end(), iLow, KeyLess{}), part.end()};
+        });
+    }
+
+    // Число строк с ключом из [iLow, iHigh] без материализации
+    size_t CountBetween(const Key &iLow, const Key &iHigh) const {
+        auto count = [&](const std::vector<Entry> &part) {
+            auto first = std::lower_bound(part.begin(), part.end(), iLow, KeyLess{});
+            return static_cast<size_t>(std::distance(first, std::upper_bound(first, part.end(), iHigh, KeyLess{})));
+        };
+        return count(main_) + count(delta_) - count(erased_);
+    }
+
+    size_t CountAbove(const Key &iLow) const {
+        auto count = [&](const std::vector<Entry> &part) {
+            return static_cast<size_t>(
+                std::distance(std::upper_bound(part.begin(), part.end(), iLow, KeyLess{}), part.end()));
+        };
+        return count(main_) + count(delta_) - count(erased_);
+    }
+
+private:
+    struct KeyLess {
+        bool operator()(const Entry &lhv, const Key &rhv) const { return lhv.first < rhv; }
+        bool operator()(const Key &lhv, const Entry &rhv) const { return lhv < rhv.first; }
+    };
+
+    static constexpr size_t kMinDeltaSize = 1024;
+
+    size_t MaxDeltaSize() const noexcept {
+        return std::max(kMinDeltaSize, static_cast<size_t>(std::sqrt(static_cast<double>(main_.size()))));
+    }
+
+    void Merge() {
+        if (!erased_.empty()) {
+            std::vector<Entry> kept;
+            kept.reserve(main_.size() - erased_.size());
+            std::set_difference(main_.begin(), main_.end(), erased_.begin(), erased_.end(), std::back_inserter(kept));
+            main_ = std::move(kept);
+            erased_.clear();
+        }
+        const auto middle = static_cast<std::ptrdiff_t>(main_.size());
+        main_.insert(main_.end(), delta_.begin(), delta_.end());
+        std::inplace_merge(main_.begin(), main_.begin() + middle, main_.end());
+        delta_.clear();
+    }
+
+    // Результат возвращается упорядоченным по номеру строки, как при полном проходе
+    template <typename RangeFn>
+    std::vector<RowId> Collect(RangeFn iRange) const {
+        std::vector<RowId> res;
+        const auto [first, last] = iRange(main_);
+        auto [erased, erasedLast] = iRange(erased_);
+        for (auto it = first; it != last; ++it) {
+            while (erased != erasedLast && *erased < *it)
+                ++erased;
+            if (erased != erasedLast && *erased == *it)
+                ++erased;
+            else
+                res.push_back(it->second);
+        }
+        const auto [deltaFirst, deltaLast] = iRange(delta_);
+        std::transform(deltaFirst, deltaLast, std::back_inserter(res), [](const Entry &e) { return e.second; });
+        std::sort(res.begin(), res.end());
+        return res;
+    }
+
+    std::vector<Entry> main_;
+    std::vector<Entry> delta_;
+    std::vector<Entry> erased_;
+};
+
+// Результат ответа по индексу: отсортированные номера строк. Если exact == false,
+// это надмножество ответа и строки нужно дополнительно проверить предикатом
+struct IndexLookup {
+    std::vector<RowId> rows;
+    bool exact = true;
+};
+
+// Вторичные индексы BookDatabase: автор и жанр -> список строк, год и рейтинг -> упорядоченный индекс.
+// Строки добавляются только в конец, поэтому списки строк всегда отсортированы. Удалённые строки
+// остаются в индексах до уплотнения базы - их отсекает маска удалённых BookDatabase
+class SecondaryIndexes {
+public:
+    using PostingList = std::vector<RowId>;
+
+    template <typename B>
+    void Insert(const B &iBook, RowId iRow) {
+        auto it = by_author_.find(iBook.author);
+        if (it == by_author_.end())
+            it = by_author_.emplace(iBook.author, PostingList{}).first;
+        it->second.push_back(iRow);
+        by_genre_[iBook.genre].push_back(iRow);
+        by_year_.Insert(iBook.year, iRow);
+        by_rating_.Insert(iBook.rating, iRow);
+    }
+
+    // Год и рейтинг книги iRow изменились на месте; автор и жанр не меняются
+    template <typename B>
+    void Update(const B &iBefore, const B &iAfter, RowId iRow) {
+        if (iBefore.year != iAfter.year) {
+            by_year_.Erase(iBefore.year, iRow);
+            by_year_.Insert(iAfter.year, iRow);
+        }
+        if (iBefore.rating != iAfter.rating) {
+            by_rating_.Erase(iBefore.rating, iRow);
+            by_rating_.Insert(iAfter.rating, iRow);
+        }
+    }
+
+    void Clear() noexcept {
+        by_author_.clear();
+        by_genre_.clear();
+        by_year_.Clear();
+        by_rating_.Clear();
+    }
+
+    const PostingList &ByAuthor(std::string_view iAuthor) const noexcept {
+        auto it = by_author_.find(iAuthor);
+        return it != by_author_.end() ? it->second : kEmpty;
+    }
+
+    const PostingList &ByGenre(Genre iGenre) const noexcept {
+        auto it = by_genre_.find(iGenre);
+        return it != by_genre_.end() ? it->second : kEmpty;
+    }
+
+    const SortedKeyIndex<int> &ByYear() const noexcept { return by_year_; }
+    const SortedKeyIndex<double> &ByRating() const noexcept { return by_rating_; }
+
+    // Отвечает на предикат по индексам, если это возможно. all_of пересекает ответы
+    // индексируемых конъюнктов (остальные проверяются потом построчно), any_of объединяет
+    // ответы, только если все его ветви индексируемы
+    template <typename P>
+    std::optional<IndexLookup> Lookup(const P &iPred) const {
+        if constexpr (std::same_as<P, pred::GenreIs>) {
+            return IndexLookup{ByGenre(iPred.genre)};
+        } else if constexpr (std::same_as<P, pred::AuthorIs>) {
+            return IndexLookup{ByAuthor(iPred.author)};
+        } else if constexpr (std::same_as<P, pred::YearBetween>) {
+            return IndexLookup{by_year_.Between(iPred.start, iPred.end)};
+        } else if constexpr (std::same_as<P, pred::RatingAbove>) {
+            return IndexLookup{by_rating_.Above(iPred.min_rating)};
+        } else if constexpr (details::IsAllOf<P>) {
+            return std::apply([this](const auto &...p) { return Intersect({Lookup(p)...}); }, iPred.preds);
+        } else if constexpr (details::IsAnyOf<P>) {
+            return std::apply([this](const auto &...p) { return Unite({Lookup(p)...}); }, iPred.preds);
+        } else {
+            return std::nullopt;
+        }
+    }
+
+private:
+    static std::optional<IndexLookup> Intersect(std::initializer_list<std::optional<IndexLookup>> iParts) {
+        std::optional<IndexLookup> res;
+        bool exact = true;
+        for (const auto &part : iParts) {
+            if (!part) {
+                exact = false;
+                continue;
+            }
+            exact = exact && part->exact;
+            if (!res) {
+                res = part;
+                continue;
+            }
+            PostingList tmp;
+            std::set_intersection(res->rows.begin(), res->rows.end(), part->rows.begin(), part->rows.end(),
+                                  std::back_inserter(tmp));
+            res->rows = std::move(tmp);
+        }
+        if (res)
+            res->exact = exact;
+        return res;
+    }
+
+    static std::optional<IndexLookup> Unite(std::initializer_list<std::optional<IndexLookup>> iParts) {
+        IndexLookup res;
+        for (const auto &part : iParts) {
+            if (!part)
+                return std::nullopt;
+            PostingList tmp;
+            std::set_union(res.rows.begin(), res.rows.end(), part->rows.begin(), part->rows.end(),
+                           std::back_inserter(tmp));
+            res.rows = std::move(tmp);
+            res.exact = res.exact && part->exact;
+        }
+        return res;
+    }
+
+    static inline const PostingList kEmpty{};
+
+    std::unordered_map<std::string_view, PostingList, TransparentStringHash, TransparentStringEqual> by_author_;
+    std::flat_map<Genre, PostingList> by_genre_;
+    SortedKeyIndex<int> by_year_;
+    SortedKeyIndex<double> by_rating_;
+};
+}  // namespace bookdb
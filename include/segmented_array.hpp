@@ -0,0 +1,85 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+namespace bookdb {
+
+// Массив только для добавления с одним писателем и читателями без блокировок.
+// Элементы лежат в сегментах удваивающегося размера и никогда не перемещаются,
+// поэтому ссылки на них действительны до разрушения массива. Писатель добавляет
+// элементы через Append и делает их видимыми через Publish; читатель берёт
+// GetPublished() и читает любые элементы с меньшими номерами
+template <typename T>
+class SegmentedArray {
+    static_assert(std::is_trivially_destructible_v<T>, "Elements are never destroyed one by one");
+
+public:
+    static constexpr size_t kFirstSegment = 1024;
+    static constexpr size_t kMaxSegments = 40;
+
+    SegmentedArray() = default;
+    SegmentedArray(const SegmentedArray &) = delete;
+    SegmentedArray &operator=(const SegmentedArray &) = delete;
+    ~SegmentedArray() {
+        for (size_t k = 0; k < kMaxSegments; ++k)
+            if (T *segment = segments_[k].load(std::memory_order_relaxed))
+                std::allocator<T>{}.deallocate(segment, SegmentSize(k));
+    }
+
+    // Только писатель
+    template <typename... Args>
+    T &Append(Args &&...iArgs) {
+        const auto [k, offset] = Locate(size_);
+        T *segment = segments_[k].load(std::memory_order_relaxed);
+        if (!segment) {
+            segment = std::allocator<T>{}.allocate(SegmentSize(k));
+            segments_[k].store(segment, std::memory_order_relaxed);
+        }
+        T *res = std::construct_at(segment + offset, std::forward<Args>(iArgs)...);
+        ++size_;
+        return *res;
+    }
+    // Release-запись: всё, что писатель сделал до Publish, видно читателю, получившему это число
+    void Publish() noexcept { published_.store(size_, std::memory_order_release); }
+    size_t GetUnpublished() const noexcept { return size_; }
+
+    size_t GetPublished() const noexcept { return published_.load(std::memory_order_acquire); }
+
+    // iPos меньше значения, ранее полученного из GetPublished()
+    const T &operator[](size_t iPos) const noexcept {
+        const auto [k, offset] = Locate(iPos);
+        return segments_[k].load(std::memory_order_relaxed)[offset];
+    }
+
+    // Первые iCount элементов непрерывными кусками по сегментам
+    template <typename F>
+    void ForEachSegment(size_t iCount, F &&iFunc) const {
+        for (size_t k = 0, begin = 0; begin < iCount; ++k) {
+            const size_t len = std::min(SegmentSize(k), iCount - begin);
+            iFunc(std::span<const T>(segments_[k].load(std::memory_order_relaxed), len));
+            begin += len;
+        }
+    }
+
+private:
+    static constexpr size_t SegmentSize(size_t k) noexcept { return kFirstSegment << k; }
+
+    // Сегмент k начинается с kFirstSegment * (2^k - 1)
+    static constexpr std::pair<size_t, size_t> Locate(size_t iPos) noexcept {
+        const size_t k = std::bit_width(iPos / kFirstSegment + 1) - 1;
+        return {k, iPos - kFirstSegment * ((size_t{1} << k) - 1)};
+    }
+
+    std::array<std::atomic<T *>, kMaxSegments> segments_{};
+    std::atomic<size_t> published_{0};
+    size_t size_ = 0;
+};
+}  // namespace bookdb
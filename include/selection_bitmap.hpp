@@ -0,0 +1,109 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace bookdb {
+
+// Битовая маска выбранных строк: бит i установлен, если строка i прошла фильтр.
+// Комбинация предикатов сводится к побитовым AND/OR над словами маски
+class SelectionBitmap {
+public:
+    using Word = std::uint64_t;
+    static constexpr size_t kWordBits = 64;
+
+    SelectionBitmap() = default;
+    explicit SelectionBitmap(size_t iSize, bool iValue = false)
+        : words_(WordCount(iSize), iValue ? ~Word{0} : Word{0}), size_(iSize) {
+        TrimTail();
+    }
+
+    static constexpr size_t WordCount(size_t iSize) noexcept { return (iSize + kWordBits - 1) / kWordBits; }
+
+    size_t size() const noexcept { return size_; }
+    bool empty() const noexcept { return size_ == 0; }
+
+    bool Test(size_t iPos) const noexcept { return (words_[iPos / kWordBits] >> (iPos % kWordBits)) & 1; }
+    void Set(size_t iPos) noexcept { words_[iPos / kWordBits] |= Word{1} << (iPos % kWordBits); }
+    void Reset(size_t iPos) noexcept { words_[iPos / kWordBits] &= ~(Word{1} << (iPos % kWordBits)); }
+
+    std::span<Word> GetWords() noexcept { return words_; }
+    std::span<const Word> GetWords() const noexcept { return words_; }
+
+    // Количество выбранных строк
+    size_t Count() const noexcept {
+        size_t res = 0;
+        for (Word w : words_)
+            res += std::popcount(w);
+        return res;
+    }
+
+    bool Any() const noexcept {
+        for (Word w : words_)
+            if (w)
+                return true;
+        return false;
+    }
+
+    SelectionBitmap &operator&=(const SelectionBitmap &iOther) noexcept {
+        for (size_t i = 0; i < words_.size(); ++i)
+            words_[i] &= iOther.words_[i];
+        return *this;
+    }
+
+    SelectionBitmap &operator|=(const SelectionBitmap &iOther) noexcept {
+        for (size_t i = 0; i < words_.size(); ++i)
+            words_[i] |= iOther.words_[i];
+        return *this;
+    }
+
+    // Снимает биты, установленные в iOther
+    SelectionBitmap &AndNot(const SelectionBitmap &iOther) noexcept {
+        for (size_t i = 0; i < words_.size() && i < iOther.words_.size(); ++i)
+            words_[i] &= ~iOther.words_[i];
+        return *this;
+    }
+
+    // Новые биты сброшены; при уменьшении отрезанные биты забываются
+    void Resize(size_t iSize) {
+        words_.resize(WordCount(iSize));
+        size_ = iSize;
+        TrimTail();
+    }
+
+    SelectionBitmap &Flip() noexcept {
+        for (Word &w : words_)
+            w = ~w;
+        TrimTail();
+        return *this;
+    }
+
+    // Обход установленных битов по возрастанию номера строки
+    template <typename F>
+    void ForEachSet(F &&iFunc) const {
+        for (size_t i = 0; i < words_.size(); ++i) {
+            for (Word w = words_[i]; w; w &= w - 1)
+                iFunc(i * kWordBits + std::countr_zero(w));
+        }
+    }
+
+    std::vector<size_t> ToIndices() const {
+        std::vector<size_t> res;
+        res.reserve(Count());
+        ForEachSet([&res](size_t iPos) { res.push_back(iPos); });
+        return res;
+    }
+
+private:
+    void TrimTail() noexcept {
+        if (const size_t tail = size_ % kWordBits; tail != 0)
+            words_.back() &= (Word{1} << tail) - 1;
+    }
+
+    std::vector<Word> words_;
+    size_t size_ = 0;
+};
+}  // namespace bookdb
@@ -0,0 +1,404 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ranges>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "split_mix64.hpp"
+#include "thread_pool.hpp"
+
+// Приближённая статистика для больших и потоковых каталогов: число различных значений,
+// квантили и самые частые значения. Каждый скетч занимает фиксированную память,
+// обновляется за O(1) (KLL - амортизированно, Space-Saving - O(log) от числа счётчиков)
+// и сливается с таким же скетчем другого потока или шарда с теми же гарантиями точности
+namespace bookdb {
+
+// HyperLogLog: оценка числа различных значений с относительной ошибкой ~1.04 / sqrt(2^precision)
+class HyperLogLog {
+public:
+    explicit HyperLogLog(uint8_t iPrecision = 14) : precision_(iPrecision) {
+        if (iPrecision < 4 || iPrecision > 18)
+            throw std::runtime_error{"Unsupported HyperLogLog precision"};
+        registers_.assign(size_t{1} << iPrecision, 0);
+    }
+
+    template <typename T>
+    void Add(const T &iValue) {
+        AddHash(details::Mix64(std::hash<T>{}(iValue)));
+    }
+
+    // Хеш должен быть уже перемешан: номер регистра берётся из старших бит
+    void AddHash(uint64_t iHash) noexcept {
+        const size_t reg = iHash >> (64 - precision_);
+        const uint64_t rest = iHash << precision_;
+        const auto rank = static_cast<uint8_t>(rest ? std::countl_zero(rest) + 1 : 64 - precision_ + 1);
+        registers_[reg] = std::max(registers_[reg], rank);
+    }
+
+    void Merge(const HyperLogLog &iOther) {
+        if (iOther.precision_ != precision_)
+            throw std::runtime_error{"HyperLogLog precision mismatch"};
+        for (size_t i = 0; i < registers_.size(); ++i)
+            registers_[i] = std::max(registers_[i], iOther.registers_[i]);
+    }
+
+    void Clear() noexcept { std::ranges::fill(registers_, 0); }
+
+    double Estimate() const noexcept {
+        const auto m = static_cast<double>(registers_.size());
+        double sum = 0.;
+        size_t zeros = 0;
+        for (uint8_t reg : registers_) {
+            sum += std::ldexp(1., -reg);
+            zeros += reg == 0;
+        }
+        const double estimate = 0.7213 / (1. + 1.079 / m) * m * m / sum;
+        // На малых мощностях точнее линейный подсчёт по пустым регистрам
+        if (estimate <= 2.5 * m && zeros)
+            return m * std::log(m / static_cast<double>(zeros));
+        return estimate;
+    }
+
+private:
+    uint8_t precision_;
+    std::vector<uint8_t> registers_;
+};
+
+// KLL: квантили с ошибкой ранга порядка 1.7 / k. Уровень h хранит значения с весом 2^h;
+// переполненный уровень сортируется, и каждое второе значение переходит на уровень выше
+class KllSketch {
+public:
+    explicit KllSketch(size_t iK = 200, uint64_t iSeed = 1) : k_(std::max<size_t>(iK, 8)), rng_(iSeed) {
+        AddLevel();
+    }
+
+    void Add(double iValue) {
+        levels_[0].push_back(iValue);
+        min_ = count_ ? std::min(min_, iValue) : iValue;
+        max_ = count_ ? std::max(max_, iValue) : iValue;
+        ++count_;
+        if (++stored_ >= capacity_)
+            Compress();
+    }
+
+    void Merge(const KllSketch &iOther) {
+        if (iOther.count_ == 0)
+            return;
+        while (levels_.size() < iOther.levels_.size())
+            AddLevel();
+        for (size_t h = 0; h < iOther.levels_.size(); ++h)
+            levels_[h].insert(levels_[h].end(), iOther.levels_[h].begin(), iOther.levels_[h].end());
+        min_ = count_ ? std::min(min_, iOther.min_) : iOther.min_;
+        max_ = count_ ? std::max(max_, iOther.max_) : iOther.max_;
+        count_ += iOther.count_;
+        stored_ += iOther.stored_;
+        while (stored_ >= capacity_)
+            Compress();
+    }
+
+    void Clear() noexcept {
+        levels_.clear();
+        AddLevel();
+        count_ = stored_ = 0;
+    }
+
+    size_t GetCount() const noexcept { return count_; }
+    double GetMin() const noexcept { return min_; }
+    double GetMax() const noexcept { return max_; }
+
+    // Значение, меньше которого примерно доля iQ потока; 0 и 1 дают точные минимум и максимум
+    double GetQuantile(double iQ) const {
+        if (count_ == 0)
+            return 0.;
+        if (iQ <= 0.)
+            return min_;
+        if (iQ >= 1.)
+            return max_;
+        const auto weighted = Weighted();
+        const double target = iQ * static_cast<double>(count_);
+        uint64_t seen = 0;
+        for (const auto &[value, weight] : weighted)
+            if (static_cast<double>(seen += weight) >= target)
+                return value;
+        return max_;
+    }
+
+    // Оценка доли значений не больше iValue
+    double GetRank(double iValue) const {
+        if (count_ == 0)
+            return 0.;
+        uint64_t below = 0;
+        for (size_t h = 0; h < levels_.size(); ++h)
+            for (double value : levels_[h])
+                if (value <= iValue)
+                    below += uint64_t{1} << h;
+        return static_cast<double>(below) / static_cast<double>(count_);
+    }
+
+private:
+    size_t LevelCapacity(size_t iLevel) const noexcept {
+        const size_t depth = levels_.size() - 1 - iLevel;
+        return std::max<size_t>(2, static_cast<size_t>(std::ceil(k_ * std::pow(2. / 3., depth))));
+    }
+
+    // Ёмкости уровней зависят только от их числа и пересчитываются при добавлении уровня
+    void AddLevel() {
+        levels_.emplace_back();
+        capacity_ = 0;
+        for (size_t h = 0; h < levels_.size(); ++h)
+            capacity_ += LevelCapacity(h);
+    }
+
+    // Сжимает нижний переполненный уровень; при нечётном размере одно значение остаётся на месте
+    void Compress() {
+        for (size_t h = 0; h < levels_.size(); ++h) {
+            if (levels_[h].size() < LevelCapacity(h))
+                continue;
+            if (h + 1 == levels_.size())
+                AddLevel();
+            auto &level = levels_[h];
+            std::ranges::sort(level);
+            double kept = 0.;
+            const bool odd = level.size() % 2;
+            if (odd) {
+                kept = level.back();
+                level.pop_back();
+            }
+            for (size_t i = rng_.Next() & 1; i < level.size(); i += 2)
+                levels_[h + 1].push_back(level[i]);
+            stored_ -= level.size() / 2;
+            level.clear();
+            if (odd)
+                level.push_back(kept);
+            return;
+        }
+    }
+
+    std::vector<std::pair<double, uint64_t>> Weighted() const {
+        std::vector<std::pair<double, uint64_t>> res;
+        res.reserve(stored_);
+        for (size_t h = 0; h < levels_.size(); ++h)
+            for (double value : levels_[h])
+                res.emplace_back(value, uint64_t{1} << h);
+        std::ranges::sort(res);
+        return res;
+    }
+
+    size_t k_;
+    details::SplitMix64 rng_;
+    std::vector<std::vector<double>> levels_;
+    size_t capacity_ = 0;
+    size_t count_ = 0;
+    size_t stored_ = 0;
+    double min_ = 0.;
+    double max_ = 0.;
+};
+
+template <typename Key>
+struct HeavyHitter {
+    Key key;
+    uint64_t count;  // оценка сверху
+    uint64_t error;  // count - error - оценка снизу
+};
+
+// Space-Saving: iCapacity счётчиков находят все ключи с весом больше total / iCapacity.
+// Счётчики лежат в min-куче, поэтому вытеснение наименьшего и увеличение - O(log iCapacity)
+template <typename Key, typename Hash = std::hash<Key>>
+class SpaceSaving {
+public:
+    explicit SpaceSaving(size_t iCapacity = 64) : capacity_(std::max<size_t>(1, iCapacity)) {}
+
+    void Add(const Key &iKey, uint64_t iWeight = 1) {
+        total_ += iWeight;
+        if (auto it = positions_.find(iKey); it != positions_.end()) {
+            heap_[it->second].count += iWeight;
+            SiftDown(it->second);
+        } else if (heap_.size() < capacity_) {
+            heap_.push_back({iKey, iWeight, 0});
+            positions_.emplace(iKey, heap_.size() - 1);
+            SiftUp(heap_.size() - 1);
+        } else {
+            // Новый ключ занимает счётчик наименьшего, унаследовав его значение как ошибку
+            positions_.erase(heap_[0].key);
+            const uint64_t floor = heap_[0].count;
+            heap_[0] = {iKey, floor + iWeight, floor};
+            positions_.emplace(iKey, 0);
+            SiftDown(0);
+        }
+    }
+
+    // Слияние по Agarwal et al.: отсутствующий в скетче ключ получает его минимальный счётчик
+    void Merge(const SpaceSaving &iOther) {
+        const uint64_t floor = MinCount();
+        const uint64_t otherFloor = iOther.MinCount();
+        std::unordered_map<Key, HeavyHitter<Key>, Hash> merged;
+        for (const auto &hitter : heap_)
+            merged.emplace(hitter.key,
+                           HeavyHitter<Key>{hitter.key, hitter.count + otherFloor, hitter.error + otherFloor});
+        for (const auto &hitter : iOther.heap_) {
+            auto [it, inserted] = merged.try_emplace(hitter.key, HeavyHitter<Key>{hitter.key, floor, floor});
+            auto &res = it->second;
+            res.count += hitter.count - (inserted ? 0 : otherFloor);
+            res.error += hitter.error - (inserted ? 0 : otherFloor);
+        }
+
+        heap_.clear();
+        for (auto &[key, hitter] : merged)
+            heap_.push_back(hitter);
+        std::ranges::sort(heap_, std::greater{}, &HeavyHitter<Key>::count);
+        if (heap_.size() > capacity_)
+            heap_.resize(capacity_);
+        Rebuild();
+        total_ += iOther.total_;
+    }
+
+    void Clear() noexcept {
+        heap_.clear();
+        positions_.clear();
+        total_ = 0;
+    }
+
+    uint64_t GetTotal() const noexcept { return total_; }
+
+    // До iCount ключей по убыванию оценки веса
+    std::vector<HeavyHitter<Key>> Top(size_t iCount) const {
+        std::vector<HeavyHitter<Key>> res(heap_);
+        std::ranges::sort(res, std::greater{}, &HeavyHitter<Key>::count);
+        res.resize(std::min(iCount, res.size()));
+        return res;
+    }
+
+private:
+    // Пока скетч не заполнен, отсутствующий ключ не встречался вовсе
+    uint64_t MinCount() const noexcept { return heap_.size() < capacity_ ? 0 : heap_[0].count; }
+
+    void Swap(size_t lhv, size_t rhv) {
+        std::swap(heap_[lhv], heap_[rhv]);
+        positions_[heap_[lhv].key] = lhv;
+        positions_[heap_[rhv].key] = rhv;
+    }
+
+    void SiftUp(size_t iPos) {
+        for (; iPos > 0 && heap_[iPos].count < heap_[(iPos - 1) / 2].count; iPos = (iPos - 1) / 2)
+            Swap(iPos, (iPos - 1) / 2);
+    }
+
+    void SiftDown(size_t iPos) {
+        for (;;) {
+            size_t smallest = iPos;
+            for (size_t child : {2 * iPos + 1, 2 * iPos + 2})
+                if (child < heap_.size() && heap_[child].count < heap_[smallest].count)
+                    smallest = child;
+            if (smallest == iPos)
+                return;
+            Swap(iPos, smallest);
+            iPos = smallest;
+        }
+    }
+
+    void Rebuild() {
+        std::ranges::make_heap(heap_, std::greater{}, &HeavyHitter<Key>::count);
+        positions_.clear();
+        for (size_t i = 0; i < heap_.size(); ++i)
+            positions_.emplace(heap_[i].key, i);
+    }
+
+    size_t capacity_;
+    std::vector<HeavyHitter<Key>> heap_;
+    std::unordered_map<Key, size_t, Hash> positions_;
+    uint64_t total_ = 0;
+};
+
+// Скетчи каталога, которые BookDatabase может поддерживать при каждой вставке:
+// различные авторы, квантили рейтинга и года, самые читаемые авторы и названия (вес - read_count).
+// Ключи - string_view на строки базы, поэтому скетч действителен, пока жива база.
+// Удаления и обновления книг скетчи не видят - до уплотнения базы они описывают все вставки
+class CatalogSketches {
+public:
+    struct Options {
+        uint8_t hll_precision = 14;
+        size_t quantile_k = 200;
+        size_t heavy_hitters = 64;
+    };
+
+    CatalogSketches() : CatalogSketches(Options{}) {}
+    explicit CatalogSketches(const Options &iOpt)
+        : options_(iOpt), authors_(iOpt.hll_precision), ratings_(iOpt.quantile_k), years_(iOpt.quantile_k, 2),
+          top_authors_(iOpt.heavy_hitters), top_titles_(iOpt.heavy_hitters) {}
+
+    template <typename B>
+    void Insert(const B &iBook) {
+        const std::string_view author = iBook.author;
+        const std::string_view title = iBook.title;
+        const auto weight = static_cast<uint64_t>(std::max(0, static_cast<int>(iBook.read_count)));
+        authors_.Add(author);
+        ratings_.Add(iBook.rating);
+        years_.Add(iBook.year);
+        top_authors_.Add(author, weight);
+        top_titles_.Add(title, weight);
+    }
+
+    void Merge(const CatalogSketches &iOther) {
+        authors_.Merge(iOther.authors_);
+        ratings_.Merge(iOther.ratings_);
+        years_.Merge(iOther.years_);
+        top_authors_.Merge(iOther.top_authors_);
+        top_titles_.Merge(iOther.top_titles_);
+    }
+
+    void Clear() noexcept {
+        authors_.Clear();
+        ratings_.Clear();
+        years_.Clear();
+        top_authors_.Clear();
+        top_titles_.Clear();
+    }
+
+    const Options &GetOptions() const noexcept { return options_; }
+    double GetDistinctAuthors() const noexcept { return authors_.Estimate(); }
+    double GetRatingQuantile(double iQ) const { return ratings_.GetQuantile(iQ); }
+    double GetYearQuantile(double iQ) const { return years_.GetQuantile(iQ); }
+    std::vector<HeavyHitter<std::string_view>> GetTopAuthors(size_t iCount) const { return top_authors_.Top(iCount); }
+    std::vector<HeavyHitter<std::string_view>> GetTopTitles(size_t iCount) const { return top_titles_.Top(iCount); }
+
+    const HyperLogLog &GetAuthorCardinality() const noexcept { return authors_; }
+    const KllSketch &GetRatings() const noexcept { return ratings_; }
+    const KllSketch &GetYears() const noexcept { return years_; }
+
+private:
+    Options options_;
+    HyperLogLog authors_;
+    KllSketch ratings_;
+    KllSketch years_;
+    SpaceSaving<std::string_view> top_authors_;
+    SpaceSaving<std::string_view> top_titles_;
+};
+
+// Скетчи по готовому контейнеру книг: каждая часть ParallelFor строит свой набор, затем они сливаются.
+// Части берут строки по номеру, поэтому нужен диапазон с произвольным доступом
+template <typename Books>
+    requires std::ranges::random_access_range<const Books> && std::ranges::sized_range<const Books>
+CatalogSketches buildCatalogSketches(const Books &iBooks, const CatalogSketches::Options &iOpt = {},
+                                     const Parallelism &iPar = {}) {
+    const auto size = static_cast<size_t>(std::ranges::size(iBooks));
+    std::vector<CatalogSketches> partials(ParallelPartCount(size, iPar), CatalogSketches(iOpt));
+    ParallelFor(size, iPar, [&](size_t part, size_t begin, size_t end) {
+        const auto first = std::ranges::begin(iBooks);
+        for (size_t row = begin; row < end; ++row)
+            partials[part].Insert(first[static_cast<std::ptrdiff_t>(row)]);
+    });
+    for (size_t part = 1; part < partials.size(); ++part)
+        partials[0].Merge(partials[part]);
+    return std::move(partials[0]);
+}
+}  // namespace bookdb
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "book_database.hpp"
+#include "mapped_file.hpp"
+
+// Бинарный снимок базы. Колонки фиксированной ширины, словарь авторов и блоб названий
+// со смещениями лежат в файле так, что после mmap ими можно пользоваться на месте:
+// загрузка - это отображение файла и проверка заголовка и границ секций.
+// Числа хранятся в порядке байт машины, файл с другим порядком отвергается
+namespace bookdb {
+namespace details {
+enum class SnapshotSection : uint32_t {
+    Ratings,
+    Years,
+    ReadCounts,
+    Genres,
+    AuthorIds,
+    TitleOffsets,
+    Titles,
+    AuthorOffsets,
+    AuthorNames,
+    Count
+};
+
+struct SnapshotSectionInfo {
+    uint64_t offset;  // от начала файла
+    uint64_t bytes;
+};
+
+struct SnapshotHeader {
+    static constexpr std::array<char, 8> kMagic{'B', 'O', 'O', 'K', 'D', 'B', 'S', 'N'};
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kByteOrderTag = 0x01020304;
+
+    std::array<char, 8> magic;
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t rows;
+    uint64_t authors;
+    uint64_t file_size;
+    std::array<SnapshotSectionInfo, static_cast<size_t>(SnapshotSection::Count)> sections;
+};
+
+static_assert(std::is_trivially_copyable_v<SnapshotHeader>);
+static_assert(sizeof(SnapshotHeader) % 8 == 0 && sizeof(Genre) == sizeof(int32_t));
+inline constexpr size_t kSnapshotAlignment = 8;
+
+// Последовательная запись секций с выравниванием
+class SnapshotWriter {
+public:
+    explicit SnapshotWriter(const std::filesystem::path &iPath) : out_(iPath, std::ios::binary | std::ios::trunc) {
+        if (!out_)
+            throw std::runtime_error{"Cannot create " + iPath.string()};
+        // Заголовок дописывается в Finish, когда известны границы всех секций
+        const SnapshotHeader placeholder{};
+        out_.write(reinterpret_cast<const char *>(&placeholder), sizeof(placeholder));
+        pos_ = sizeof(placeholder);
+    }
+
+    template <typename T>
+    void Write(SnapshotHeader &ioHeader, SnapshotSection iSection, std::span<const T> iData) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        auto &info = ioHeader.sections[static_cast<size_t>(iSection)];
+        info = {pos_, iData.size_bytes()};
+        out_.write(reinterpret_cast<const char *>(iData.data()), static_cast<std::streamsize>(iData.size_bytes()));
+        pos_ += iData.size_bytes();
+        const size_t padding = (kSnapshotAlignment - pos_ % kSnapshotAlignment) % kSnapshotAlignment;
+        Pad(padding);
+        pos_ += padding;
+    }
+
+    void Finish(SnapshotHeader &ioHeader) {
+        ioHeader.file_size = pos_;
+        out_.seekp(0);
+        out_.write(reinterpret_cast<const char *>(&ioHeader), sizeof(ioHeader));
+        out_.flush();
+        if (!out_)
+            throw std::runtime_error{"Snapshot write failed"};
+    }
+
+private:
+    void Pad(size_t iCount) {
+        static constexpr std::array<char, kSnapshotAlignment> zeros{};
+        out_.write(zeros.data(), static_cast<std::streamsize>(iCount));
+    }
+
+    std::ofstream out_;
+    uint64_t pos_;
+};
+}  // namespace details
+
+// Снимок, отображённый в память. Колонки и строки читаются прямо из отображения,
+// Book из operator[] ссылается на название и автора внутри файла и действителен,
+// пока жив снимок
+class Snapshot {
+public:
+    // Header - только заголовок и границы секций, O(1). Full - ещё и смещения строк,
+    // номера авторов и жанры, O(n); без неё повреждённый файл может дать чтение за границей
+    enum class Verify { Header, Full };
+
+    explicit Snapshot(const std::filesystem::path &iPath, Verify iVerify = Verify::Full) : file_(iPath) {
+        const std::string_view data = file_.GetData();
+        if (data.size() < sizeof(details::SnapshotHeader))
+            throw std::runtime_error{"Snapshot is truncated"};
+        std::memcpy(&header_, data.data(), sizeof(header_));
+        if (header_.magic != details::SnapshotHeader::kMagic)
+            throw std::runtime_error{"Not a book snapshot"};
+        if (header_.version != details::SnapshotHeader::kVersion)
+            throw std::runtime_error{"Unsupported snapshot version " + std::to_string(header_.version)};
+        if (header_.byte_order != details::SnapshotHeader::kByteOrderTag)
+            throw std::runtime_error{"Snapshot byte order does not match"};
+        if (header_.file_size != data.size())
+            throw std::runtime_error{"Snapshot size does not match its header"};
+        // На строку приходится хотя бы рейтинг, на автора - смещение имени, поэтому при верных
+        // размерах секций rows + 1 и authors + 1 ниже не переполняются
+        if (header_.rows > data.size() / sizeof(double) || header_.authors >= data.size() / sizeof(uint64_t))
+            throw std::runtime_error{"Snapshot header is corrupted"};
+
+        using enum details::SnapshotSection;
+        ratings_ = Section<double>(Ratings, header_.rows);
+        years_ = Section<int32_t>(Years, header_.rows);
+        read_counts_ = Section<int32_t>(ReadCounts, header_.rows);
+        genres_ = Section<Genre>(Genres, header_.rows);
+        author_ids_ = Section<AuthorId>(AuthorIds, header_.rows);
+        title_offsets_ = Section<uint64_t>(TitleOffsets, header_.rows + 1);
+        titles_ = Section<char>(Titles, title_offsets_.back());
+        author_offsets_ = Section<uint64_t>(AuthorOffsets, header_.authors + 1);
+        author_names_ = Section<char>(AuthorNames, author_offsets_.back());
+
+        if (iVerify == Verify::Full)
+            VerifyContents();
+        file_.AdviseSequential();
+    }
+
+    size_t size() const noexcept { return ratings_.size(); }
+    bool empty() const noexcept { return ratings_.empty(); }
+    size_t GetAuthorCount() const noexcept { return author_offsets_.size() - 1; }
+
+    std::span<const double> GetRatings() const noexcept { return ratings_; }
+    std::span<const int> GetYears() const noexcept { return years_; }
+    std::span<const int> GetReadCounts() const noexcept { return read_counts_; }
+    std::span<const Genre> GetGenres() const noexcept { return genres_; }
+    std::span<const AuthorId> GetAuthorIds() const noexcept { return author_ids_; }
+
+    std::string_view GetTitle(RowId iRow) const noexcept { return Slice(titles_, title_offsets_, iRow); }
+    std::string_view GetAuthorName(AuthorId iId) const noexcept { return Slice(author_names_, author_offsets_, iId); }
+
+    Book operator[](RowId iRow) const {
+        Book res{GetTitle(iRow), GetAuthorName(author_ids_[iRow]), years_[iRow], genres_[iRow],
+                 ratings_[iRow], read_counts_[iRow]};
+        res.author_id = author_ids_[iRow];
+        return res;
+    }
+
+    // Строки снимка как диапазон Book
+    auto Rows() const {
+        return std::views::iota(RowId{0}, size()) | std::views::transform([this](RowId row) { return (*this)[row]; });
+    }
+
+private:
+    template <typename T>
+    std::span<const T> Section(details::SnapshotSection iSection, uint64_t iCount) const {
+        const auto &[offset, bytes] = header_.sections[static_cast<size_t>(iSection)];
+        // Число элементов проверяется первым, чтобы произведение ниже не переполнилось
+        if (iCount > file_.size() || bytes != iCount * sizeof(T) || offset > file_.size() ||
+            bytes > file_.size() - offset || offset % alignof(T) != 0)
+            throw std::runtime_error{"Snapshot section is out of bounds"};
+        return {reinterpret_cast<const T *>(file_.GetData().data() + offset), static_cast<size_t>(iCount)};
+    }
+
+    static std::string_view Slice(std::span<const char> iBlob, std::span<const uint64_t> iOffsets, size_t i) noexcept {
+        return {iBlob.data() + iOffsets[i], iOffsets[i + 1] - iOffsets[i]};
+    }
+
+    static void VerifyOffsets(std::span<const uint64_t> iOffsets) {
+        if (iOffsets.front() != 0 || !std::ranges::is_sorted(iOffsets))
+            throw std::runtime_error{"Snapshot string offsets are corrupted"};
+    }
+
+    void VerifyContents() const {
+        VerifyOffsets(title_offsets_);
+        VerifyOffsets(author_offsets_);
+        if (std::ranges::any_of(author_ids_, [this](AuthorId id) { return id >= GetAuthorCount(); }))
+            throw std::runtime_error{"Snapshot author id is out of range"};
+        if (std::ranges::any_of(genres_, [](Genre g) { return details::GenreSlot(g) != static_cast<size_t>(g); }))
+            throw std::runtime_error{"Snapshot genre is out of range"};
+    }
+
+    MappedFile file_;
+    details::SnapshotHeader header_{};
+    std::span<const double> ratings_;
+    std::span<const int32_t> years_;
+    std::span<const int32_t> read_counts_;
+    std::span<const Genre> genres_;
+    std::span<const AuthorId> author_ids_;
+    std::span<const uint64_t> title_offsets_;
+    std::span<const char> titles_;
+    std::span<const uint64_t> author_offsets_;
+    std::span<const char> author_names_;
+};
+
+// Снимок пишется во временный файл рядом и переименовывается, поэтому читатели
+// никогда не видят наполовину записанный снимок; при ошибке временный файл удаляется.
+// Удалённые строки в снимок не попадают
+template <BookContainerLike T>
+void saveSnapshot(const BookDatabase<T> &iDb, const std::filesystem::path &iPath) {
+    std::vector<double> ratings;
+    std::vector<int32_t> years, readCounts;
+    std::vector<Genre> genres;
+    std::vector<AuthorId> authorIds;
+    std::vector<uint64_t> titleOffsets{0};
+    std::string titles;
+    for (auto *column : {&years, &readCounts})
+        column->reserve(iDb.size());
+    ratings.reserve(iDb.size());
+    genres.reserve(iDb.size());
+    authorIds.reserve(iDb.size());
+    titleOffsets.reserve(iDb.size() + 1);
+
+    for (RowId row = 0; row < iDb.size(); ++row) {
+        if (iDb.IsErased(row))
+            continue;
+        const auto &book = iDb.GetBooks()[row];
+        ratings.push_back(book.rating);
+        years.push_back(book.year);
+        readCounts.push_back(book.read_count);
+        genres.push_back(book.genre);
+        authorIds.push_back(book.author_id);
+        titles.append(book.title);
+        titleOffsets.push_back(titles.size());
+    }
+
+    std::vector<uint64_t> authorOffsets{0};
+    std::string authorNames;
+    authorOffsets.reserve(iDb.GetAuthors().size() + 1);
+    for (std::string_view author : iDb.GetAuthors()) {
+        authorNames.append(author);
+        authorOffsets.push_back(authorNames.size());
+    }
+
+    details::SnapshotHeader header{};
+    header.magic = details::SnapshotHeader::kMagic;
+    header.version = details::SnapshotHeader::kVersion;
+    header.byte_order = details::SnapshotHeader::kByteOrderTag;
+    header.rows = ratings.size();
+    header.authors = iDb.GetAuthors().size();
+
+    auto tmpPath = iPath;
+    tmpPath += ".tmp";
+    try {
+        {
+            using enum details::SnapshotSection;
+            details::SnapshotWriter writer(tmpPath);
+            writer.Write(header, Ratings, std::span<const double>(ratings));
+            writer.Write(header, Years, std::span<const int32_t>(years));
+            writer.Write(header, ReadCounts, std::span<const int32_t>(readCounts));
+            writer.Write(header, Genres, std::span<const Genre>(genres));
+            writer.Write(header, AuthorIds, std::span<const AuthorId>(authorIds));
+            writer.Write(header, TitleOffsets, std::span<const uint64_t>(titleOffsets));
+            writer.Write(header, Titles, std::span<const char>(titles));
+            writer.Write(header, AuthorOffsets, std::span<const uint64_t>(authorOffsets));
+            writer.Write(header, AuthorNames, std::span<const char>(authorNames));
+            writer.Finish(header);
+        }
+        std::filesystem::rename(tmpPath, iPath);
+    } catch (...) {
+        std::error_code ec;
+        std::filesystem::remove(tmpPath, ec);
+        throw;
+    }
+}
+
+// Переносит снимок в базу. Словарь авторов интернируется целиком до вставки книг,
+// названия копируются в арену базы, поэтому снимок после этого можно закрыть
+template <BookContainerLike T>
+void loadSnapshot(BookDatabase<T> &ioDb, const Snapshot &iSnapshot) {
+    std::vector<AuthorId> remap(iSnapshot.GetAuthorCount());
+    for (AuthorId id = 0; id < remap.size(); ++id)
+        remap[id] = ioDb.InternAuthor(iSnapshot.GetAuthorName(id));
+
+    ioDb.Reserve(ioDb.size() + iSnapshot.size());
+    for (Book book : iSnapshot.Rows()) {
+        book.author_id = remap[book.author_id];
+        book.author = ioDb.GetAuthors().GetName(book.author_id);
+        ioDb.PushBack(book);
+    }
+}
+
+template <BookContainerLike T>
+void loadSnapshot(BookDatabase<T> &ioDb, const std::filesystem::path &iPath) {
+    loadSnapshot(ioDb, Snapshot(iPath));
+}
+}  // namespace bookdb
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+namespace bookdb::details {
+// Финализатор SplitMix64: перемешивает все биты ключа, годится для хешей с плохими младшими битами
+constexpr uint64_t Mix64(uint64_t z) noexcept {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// SplitMix64: быстрый, с хорошим перемешиванием и полностью определённым результатом
+class SplitMix64 {
+public:
+    explicit SplitMix64(uint64_t iSeed) noexcept : state_(iSeed) {}
+
+    uint64_t Next() noexcept { return Mix64(state_ += 0x9E3779B97F4A7C15ull); }
+    // [0, 1) из старших 53 бит
+    double NextDouble() noexcept { return static_cast<double>(Next() >> 11) * 0x1.0p-53; }
+    uint64_t NextBelow(uint64_t iBound) noexcept { return iBound ? Next() % iBound : 0; }
+
+private:
+    uint64_t state_;
+};
+}  // namespace bookdb::details
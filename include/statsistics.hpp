@@ -3,12 +3,16 @@
 #include <algorithm>
 #include <array>
 #include <iterator>
+#include <numeric>
 #include <random>
 #include <span>
 #include <stdexcept>
 #include <string_view>
+#include <vector>
 
 #include "book_database.hpp"
+#include "metrics.hpp"
+#include "zone_map.hpp"
 
 #include <print>
 
@@ -35,61 +39,198 @@ using HistogramFlatCont = std::flat_map<std::string, size_t, Comparator>;
 template <typename Comparator>
 using GenreRatingsFlatCont = std::flat_map<Genre, double, Comparator>;
 
+// Число книг каждого автора, индекс - номер автора в словаре базы
+template <BookContainerLike T>
+std::vector<size_t> buildAuthorHistogramDense(const BookDatabase<T> &iCont) {
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    if (const auto *aggregates = iCont.GetAggregates()) {
+        const auto counts = aggregates->GetAuthorCounts();
+        std::vector<size_t> res(counts.begin(), counts.end());
+        res.resize(iCont.GetAuthors().size());
+        return res;
+    }
+    // Счётчики ссылок на авторов уже учитывают удалённые строки
+    if (iCont.GetErasedCount()) {
+        const auto refs = iCont.GetAuthorRefCounts();
+        std::vector<size_t> res(refs.begin(), refs.end());
+        res.resize(iCont.GetAuthors().size());
+        return res;
+    }
+    std::vector<size_t> res(iCont.GetAuthors().size());
+    if constexpr (ColumnarBookContainerLike<T>) {
+        for (AuthorId id : iCont.GetBooks().GetAuthorIds())
+            ++res[id];
+    } else {
+        for (const auto &book : iCont)
+            ++res[book.author_id];
+    }
+    return res;
+}
+
+namespace details {
+// Плотные счётчики в flat_map по именам. Ключи сортируются один раз целиком,
+// а не вставляются по одному со сдвигом хвоста
+template <typename Comparator>
+HistogramFlatCont<Comparator> MakeAuthorHistogram(const AuthorDictionary &iAuthors, std::span<const size_t> iCounts) {
+    std::vector<AuthorId> ids;
+    ids.reserve(iCounts.size());
+    for (size_t id = 0; id < iCounts.size(); ++id)
+        if (iCounts[id])
+            ids.push_back(static_cast<AuthorId>(id));
+    std::sort(ids.begin(), ids.end(), [&iAuthors, comp = Comparator{}](AuthorId l, AuthorId r) {
+        return comp(iAuthors.GetName(l), iAuthors.GetName(r));
+    });
+
+    typename HistogramFlatCont<Comparator>::key_container_type keys;
+    typename HistogramFlatCont<Comparator>::mapped_container_type values;
+    keys.reserve(ids.size());
+    values.reserve(ids.size());
+    for (AuthorId id : ids) {
+        keys.emplace_back(iAuthors.GetName(id));
+        values.push_back(iCounts[id]);
+    }
+    HistogramFlatCont<Comparator> res;
+    res.replace(std::move(keys), std::move(values));
+    return res;
+}
+}  // namespace details
+
 template <BookContainerLike T, typename Comparator = TransparentStringLess>
 auto buildAuthorHistogramFlat(const BookDatabase<T> &iCont) {
-    HistogramFlatCont<Comparator> res;
-    details::ReserveSpaceInFlatCont(res, iCont.GetAuthors().size());
-    for (const auto &a : iCont)
-        ++res[std::string(a.author)];
+    return details::MakeAuthorHistogram<Comparator>(iCont.GetAuthors(), buildAuthorHistogramDense(iCont));
+}
+
+namespace details {
+// Сумма рейтингов и число книг по слотам жанров
+using GenrePartial = std::array<std::pair<double, size_t>, kGenreCount>;
+
+template <typename Comparator>
+GenreRatingsFlatCont<Comparator> MakeGenreRatings(const GenrePartial &iSums) {
+    GenreRatingsFlatCont<Comparator> res;
+    ReserveSpaceInFlatCont(res, kGenreCount);
+    for (size_t i = 0; i < iSums.size(); ++i) {
+        auto [totalRating, count] = iSums[i];
+        res[static_cast<Genre>(i)] = count ? totalRating / count : 0.;
+    }
     return res;
 }
+}  // namespace details
 
 template <ConstBookIterator T, typename Comparator = std::less<Genre>>
 auto calculateGenreRatings(T iItBegin, T iItEnd) {
-    GenreRatingsFlatCont<Comparator> res;
-    details::ReserveSpaceInFlatCont(res, static_cast<size_t>(Genre::Unknown) + 1);
-
-    std::array<std::pair<double, size_t>, static_cast<size_t>(Genre::Unknown) + 1> tmp{};
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    details::GenrePartial tmp{};
     for (auto it = iItBegin; it != iItEnd; ++it) {
-        auto &[totalRating, count] = tmp[static_cast<size_t>(it->genre)];
+        auto &[totalRating, count] = tmp[details::GenreSlot(it->genre)];
         ++count;
         totalRating += it->rating;
     }
+    return details::MakeGenreRatings<Comparator>(tmp);
+}
 
-    for (size_t i = 0; i < tmp.size(); ++i) {
-        auto [totalRating, count] = tmp[i];
-        res[static_cast<Genre>(i)] = count ? totalRating / count : 0.;
+// Средний рейтинг по жанрам среди книг, для которых выполняется iPred. Со сводками блоков базы
+// блоки, где iPred не выполняется, пропускаются, а целиком подходящие берутся из сумм сводки
+template <BookContainerLike T, typename P, typename Comparator = std::less<Genre>>
+auto calculateGenreRatings(const BookDatabase<T> &iDb, const P &iPred) {
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    details::GenrePartial tmp{};
+    const auto &books = iDb.GetBooks();
+    auto addRows = [&](RowId begin, RowId end) {
+        for (RowId row = begin; row < end; ++row) {
+            const auto &book = books[row];
+            if (iDb.IsErased(row) || !iPred(book))
+                continue;
+            auto &[totalRating, count] = tmp[details::GenreSlot(book.genre)];
+            ++count;
+            totalRating += book.rating;
+        }
+    };
+
+    if (const ZoneMap *zones = iDb.GetZoneMap(); zones && zones->size() == books.size()) {
+        zones->ForEachCandidate(iPred, [&](const Zone &zone, RowId begin, RowId end, ZoneMatch match) {
+            if (match == ZoneMatch::Partial)
+                return addRows(begin, end);
+            for (size_t slot = 0; slot < kGenreCount; ++slot) {
+                tmp[slot].first += zone.genre_ratings[slot].first;
+                tmp[slot].second += zone.genre_ratings[slot].second;
+            }
+        });
+    } else {
+        addRows(0, books.size());
     }
-
-    return res;
+    return details::MakeGenreRatings<Comparator>(tmp);
 }
 
 template <BookContainerLike T>
 double calculateAverageRating(const BookDatabase<T> &cont) {
-    const double sum = std::transform_reduce(cont.cbegin(), cont.cend(), 0.0, std::plus<>(),
-                                             [](const auto &item) { return item.rating; });
-    return !cont.empty() ? sum / cont.size() : 0.0;
+    BOOKDB_METRIC_TIMER(Stats);
+    BOOKDB_METRIC_ADD(StatsCalls, 1);
+    if (const auto *aggregates = cont.GetAggregates())
+        return aggregates->GetAverageRating();
+    if (cont.GetErasedCount()) {
+        const auto &books = cont.GetBooks();
+        double sum = 0.0;
+        for (RowId row = 0; row < books.size(); ++row)
+            sum += cont.IsErased(row) ? 0.0 : books[row].rating;
+        return cont.GetLiveCount() ? sum / cont.GetLiveCount() : 0.0;
+    }
+    if constexpr (ColumnarBookContainerLike<T>) {
+        const auto ratings = cont.GetBooks().GetRatings();
+        const double sum = std::reduce(ratings.begin(), ratings.end(), 0.0);
+        return !ratings.empty() ? sum / ratings.size() : 0.0;
+    } else {
+        const double sum = std::transform_reduce(cont.cbegin(), cont.cend(), 0.0, std::plus<>(),
+                                                 [](const auto &item) { return item.rating; });
+        return !cont.empty() ? sum / cont.size() : 0.0;
+    }
 }
 
-template <BookContainerLike T>
-auto sampleRandomBooks(const BookDatabase<T> &iCont, size_t N) {
+// Равномерная выборка без возвращения за один проход. Для повторных и взвешенных выборок
+// из одной базы - BookSampler из book_sampler.hpp. Удалённые строки не выбираются
+template <BookContainerLike T, std::uniform_random_bit_generator G>
+auto sampleRandomBooks(const BookDatabase<T> &iCont, size_t N, G &ioGen) {
     std::vector<std::reference_wrapper<const Book>> res;
-    if (iCont.size() < N)
+    if (iCont.GetLiveCount() < N)
         throw std::runtime_error{"iCont.size() < N"};
 
     res.reserve(N);
-    std::sample(iCont.begin(), iCont.end(), std::back_inserter(res), N, std::mt19937{std::random_device{}()});
+    if (!iCont.GetErasedCount()) {
+        std::sample(iCont.begin(), iCont.end(), std::back_inserter(res), N, ioGen);
+        return res;
+    }
+    // Выборочный отбор по живым строкам: строка берётся с вероятностью "осталось взять / осталось строк"
+    size_t left = iCont.GetLiveCount();
+    for (RowId row = 0; res.size() < N; ++row) {
+        if (iCont.IsErased(row))
+            continue;
+        if (std::uniform_int_distribution<size_t>(0, --left)(ioGen) < N - res.size())
+            res.emplace_back(iCont.GetBooks()[row]);
+    }
     return res;
 }
 
+// Генератор потока засевается один раз, а не на каждый вызов
+template <BookContainerLike T>
+auto sampleRandomBooks(const BookDatabase<T> &iCont, size_t N) {
+    thread_local std::mt19937_64 gen{std::random_device{}()};
+    return sampleRandomBooks(iCont, N, gen);
+}
+
+// Переставляет книги базы на месте в порядке comp через ClusterBy, поэтому BookId, маска удалённых
+// и индексы остаются согласованными с номерами строк, а удалённые строки отбрасываются.
+// Полная сортировка, O(N log N). Без перестановки, для константной базы и параллельных
+// читателей - getTopKBy из top_k.hpp
 template <BookContainerLike T, BookComparator Comparator>
 std::span<const typename BookDatabase<T>::value_type> getTopNBy(BookDatabase<T> &iCont, size_t N, Comparator comp) {
-    if (iCont.size() < N)
-        throw std::runtime_error{"iCont.size() < N"};
+    if (iCont.GetLiveCount() < N)
+        throw std::runtime_error{"iCont.GetLiveCount() < N"};
+    BOOKDB_METRIC_TIMER(TopK);
+    BOOKDB_METRIC_ADD(TopKCalls, 1);
 
-    std::nth_element(iCont.begin(), iCont.begin() + N, iCont.end(), comp);
-    auto tmp = std::span<typename BookDatabase<T>::value_type>(iCont.begin(), iCont.begin() + N);
-    std::sort(tmp.begin(), tmp.end(), comp);
-    return tmp;
+    iCont.ClusterBy(comp);
+    return std::span<const typename BookDatabase<T>::value_type>(iCont.GetBooks().begin(), N);
 }
 }  // namespace bookdb
\ No newline at end of file
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace bookdb {
+
+// Хранилище строк большими непрерывными блоками. Строки только добавляются, string_view
+// на них действительны до Clear или разрушения последнего владельца блока.
+// Копия арены разделяет уже заполненные блоки с оригиналом (они неизменяемы),
+// но пишет новые строки только в свои блоки
+class StringArena {
+public:
+    static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+    explicit StringArena(size_t iBlockSize = kDefaultBlockSize) noexcept : block_size_(iBlockSize) {}
+
+    StringArena(const StringArena &iOther)
+        : blocks_(iOther.blocks_), block_size_(iOther.block_size_), bytes_reserved_(iOther.bytes_reserved_) {}
+    StringArena(StringArena &&iOther) noexcept
+        : blocks_(std::move(iOther.blocks_)), block_size_(iOther.block_size_), cursor_(iOther.cursor_),
+          left_(iOther.left_), bytes_reserved_(iOther.bytes_reserved_) {
+        iOther.Clear();
+    }
+    StringArena &operator=(const StringArena &iOther) {
+        if (this != &iOther) {
+            blocks_ = iOther.blocks_;
+            block_size_ = iOther.block_size_;
+            cursor_ = nullptr;
+            left_ = 0;
+            bytes_reserved_ = iOther.bytes_reserved_;
+        }
+        return *this;
+    }
+    StringArena &operator=(StringArena &&iOther) noexcept {
+        if (this != &iOther) {
+            blocks_ = std::move(iOther.blocks_);
+            block_size_ = iOther.block_size_;
+            cursor_ = iOther.cursor_;
+            left_ = iOther.left_;
+            bytes_reserved_ = iOther.bytes_reserved_;
+            iOther.Clear();
+        }
+        return *this;
+    }
+
+    std::string_view Store(std::string_view iStr) {
+        if (iStr.empty())
+            return {};
+        if (iStr.size() > left_) {
+            // Длинная строка получает отдельный блок, чтобы не бросать остаток текущего
+            if (iStr.size() > block_size_ / 2)
+                return CopyTo(Allocate(iStr.size()), iStr);
+            cursor_ = Allocate(block_size_);
+            left_ = block_size_;
+        }
+        const std::string_view res = CopyTo(cursor_, iStr);
+        cursor_ += iStr.size();
+        left_ -= iStr.size();
+        return res;
+    }
+
+    // Следующие iBytes байт строк лягут в один блок: при нехватке места в текущем блоке
+    // заводится новый размером не меньше iBytes, остаток текущего не используется
+    void Reserve(size_t iBytes) {
+        if (iBytes <= left_)
+            return;
+        const size_t size = std::max(block_size_, iBytes);
+        cursor_ = Allocate(size);
+        left_ = size;
+    }
+
+    // Освобождение всех строк - по одному free на блок
+    void Clear() noexcept {
+        blocks_.clear();
+        cursor_ = nullptr;
+        left_ = 0;
+        bytes_reserved_ = 0;
+    }
+
+    size_t GetBlockCount() const noexcept { return blocks_.size(); }
+    size_t GetBytesReserved() const noexcept { return bytes_reserved_; }
+
+private:
+    char *Allocate(size_t iSize) {
+        blocks_.push_back(std::make_shared_for_overwrite<char[]>(iSize));
+        bytes_reserved_ += iSize;
+        return blocks_.back().get();
+    }
+
+    static std::string_view CopyTo(char *oDest, std::string_view iStr) noexcept {
+        std::memcpy(oDest, iStr.data(), iStr.size());
+        return {oDest, iStr.size()};
+    }
+
+    std::vector<std::shared_ptr<char[]>> blocks_;
+    size_t block_size_;
+    char *cursor_ = nullptr;
+    size_t left_ = 0;
+    size_t bytes_reserved_ = 0;
+};
+}  // namespace bookdb
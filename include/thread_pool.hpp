@@ -0,0 +1,159 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace bookdb {
+
+// Пул потоков фиксированного размера с общей очередью задач
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t iThreads = std::max(1u, std::thread::hardware_concurrency())) {
+        workers_.reserve(iThreads);
+        for (size_t i = 0; i < iThreads; ++i)
+            workers_.emplace_back([this] { Work(); });
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+    }
+
+    size_t size() const noexcept { return workers_.size(); }
+
+    template <typename F>
+    auto Submit(F &&iTask) {
+        using Result = std::invoke_result_t<std::decay_t<F>>;
+        std::packaged_task<Result()> task(std::forward<F>(iTask));
+        auto future = task.get_future();
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.emplace(std::move(task));
+        }
+        cv_.notify_one();
+        return future;
+    }
+
+    // Ожидание результата, во время которого вызывающий поток сам разбирает очередь.
+    // Благодаря этому вложенные ParallelFor из задач пула не блокируют друг друга
+    template <typename T>
+    T Wait(std::future<T> &iFuture) {
+        while (iFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            if (!RunPendingTask())
+                iFuture.wait();
+        }
+        return iFuture.get();
+    }
+
+    // Общий пул процесса по числу аппаратных потоков
+    static ThreadPool &Default() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    bool RunPendingTask() {
+        std::move_only_function<void()> task;
+        {
+            std::lock_guard lock(mutex_);
+            if (tasks_.empty())
+                return false;
+            task = std::move(tasks_.front());
+            tasks_.pop();
+        }
+        task();
+        return true;
+    }
+
+    void Work() {
+        while (true) {
+            std::move_only_function<void()> task;
+            {
+                std::unique_lock lock(mutex_);
+                cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty())
+                    return;
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::queue<std::move_only_function<void()>> tasks_;
+    bool stop_ = false;
+    // Объявлен последним, чтобы потоки завершились раньше, чем разрушится очередь
+    std::vector<std::jthread> workers_;
+};
+
+// Степень параллелизма для параллельных алгоритмов библиотеки
+struct Parallelism {
+    size_t threads = 0;           // 0 - по числу потоков пула
+    ThreadPool *pool = nullptr;   // nullptr - ThreadPool::Default()
+    size_t min_part_size = 4096;  // меньшие диапазоны не делятся
+};
+
+// Число непрерывных частей, на которые ParallelFor разделит диапазон такого размера
+inline size_t ParallelPartCount(size_t iSize, const Parallelism &iPar) {
+    const ThreadPool &pool = iPar.pool ? *iPar.pool : ThreadPool::Default();
+    const size_t wanted = iPar.threads ? iPar.threads : pool.size();
+    const size_t byGrain = std::max<size_t>(1, iSize / std::max<size_t>(1, iPar.min_part_size));
+    return std::max<size_t>(1, std::min(wanted, byGrain));
+}
+
+// Делит [0, iSize) на ParallelPartCount частей и вызывает iFunc(part, begin, end) для каждой.
+// Часть 0 считается в вызывающем потоке, остальные - в пуле. Части не пересекаются,
+// поэтому каждая может писать в свой частичный результат без синхронизации
+template <typename F>
+void ParallelFor(size_t iSize, const Parallelism &iPar, F &&iFunc) {
+    const size_t parts = ParallelPartCount(iSize, iPar);
+    if (parts == 1) {
+        iFunc(size_t{0}, size_t{0}, iSize);
+        return;
+    }
+
+    ThreadPool &pool = iPar.pool ? *iPar.pool : ThreadPool::Default();
+    auto bound = [iSize, parts](size_t part) { return iSize * part / parts; };
+    std::vector<std::future<void>> futures;
+    futures.reserve(parts - 1);
+    for (size_t part = 1; part < parts; ++part)
+        futures.push_back(pool.Submit([&iFunc, part, b = bound(part), e = bound(part + 1)] { iFunc(part, b, e); }));
+
+    std::exception_ptr error;
+    try {
+        iFunc(size_t{0}, size_t{0}, bound(1));
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // Дожидаемся всех частей до выхода: задачи ссылаются на iFunc
+    for (auto &future : futures) {
+        try {
+            pool.Wait(future);
+        } catch (...) {
+            if (!error)
+                error = std::current_exception();
+        }
+    }
+    if (error)
+        std::rethrow_exception(error);
+}
+}  // namespace bookdb
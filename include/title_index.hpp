@@ -0,0 +1,259 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "book.hpp"
+#include "concepts.hpp"
+#include "metrics.hpp"
+
+namespace bookdb {
+namespace details {
+// Регистр сворачивается только для ASCII; байты UTF-8 сравниваются как есть
+constexpr char FoldAscii(char c) noexcept { return 'A' <= c && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; }
+
+constexpr bool IsWordChar(char c) noexcept {
+    const char folded = FoldAscii(c);
+    return ('0' <= c && c <= '9') || ('a' <= folded && folded <= 'z') || static_cast<unsigned char>(c) >= 0x80;
+}
+
+inline size_t FindFolded(std::string_view iText, std::string_view iFoldedQuery, size_t iFrom = 0) noexcept {
+    if (iFrom > iText.size())
+        return std::string_view::npos;
+    auto it = std::search(iText.begin() + iFrom, iText.end(), iFoldedQuery.begin(), iFoldedQuery.end(),
+                          [](char lhv, char rhv) { return FoldAscii(lhv) == rhv; });
+    return it != iText.end() || iFoldedQuery.empty() ? static_cast<size_t>(it - iText.begin())
+                                                     : std::string_view::npos;
+}
+
+// Возрастающие номера строк, сжатые как разности в varint (7 бит на байт).
+// Плотные списки частых n-грамм занимают около байта на строку
+class PostingList {
+public:
+    // Номера добавляются строго по возрастанию
+    void Append(RowId iRow) {
+        RowId delta = count_ ? iRow - last_ : iRow;
+        while (delta >= 0x80) {
+            bytes_.push_back(static_cast<uint8_t>(delta | 0x80));
+            delta >>= 7;
+        }
+        bytes_.push_back(static_cast<uint8_t>(delta));
+        last_ = iRow;
+        ++count_;
+    }
+
+    size_t size() const noexcept { return count_; }
+    size_t GetBytes() const noexcept { return bytes_.size(); }
+
+    template <typename F>
+    void ForEach(F &&iFunc) const {
+        RowId row = 0;
+        size_t pos = 0;
+        for (size_t i = 0; i < count_; ++i) {
+            RowId delta = 0;
+            for (int shift = 0;; shift += 7) {
+                const uint8_t byte = bytes_[pos++];
+                delta |= static_cast<RowId>(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    break;
+            }
+            row = i ? row + delta : delta;
+            iFunc(row);
+        }
+    }
+
+    std::vector<RowId> Decode() const {
+        std::vector<RowId> res;
+        res.reserve(count_);
+        ForEach([&res](RowId row) { res.push_back(row); });
+        return res;
+    }
+
+    // Оставляет в ioRows только номера из списка; оба набора упорядочены
+    void IntersectInto(std::vector<RowId> &ioRows) const {
+        auto out = ioRows.begin();
+        auto cur = ioRows.begin();
+        ForEach([&](RowId row) {
+            while (cur != ioRows.end() && *cur < row)
+                ++cur;
+            if (cur != ioRows.end() && *cur == row)
+                *out++ = *cur++;
+        });
+        ioRows.erase(out, ioRows.end());
+    }
+
+private:
+    std::vector<uint8_t> bytes_;
+    RowId last_ = 0;
+    size_t count_ = 0;
+};
+}  // namespace details
+
+enum class TitleMatchMode { Substring, Prefix };
+
+struct TitleSearchOptions {
+    TitleMatchMode mode = TitleMatchMode::Substring;
+    bool case_sensitive = false;
+    // 0 - без ограничения
+    size_t limit = 0;
+};
+
+// Оценка: совпадение с начала названия выше совпадения с начала слова, а оно выше совпадения
+// внутри слова; при равенстве выше более короткое название
+struct TitleMatch {
+    RowId row;
+    double score;
+};
+
+// Инвертированный индекс n-грамм названий (по умолчанию триграмм) в нижнем регистре ASCII.
+// Индекс только сужает множество кандидатов, совпадение проверяется по самому названию,
+// поэтому ложных срабатываний в результате нет
+class TitleIndex {
+public:
+    static constexpr size_t kMaxGramSize = 8;
+
+    explicit TitleIndex(size_t iGramSize = 3) : gram_size_(iGramSize) {
+        if (iGramSize == 0 || iGramSize > kMaxGramSize)
+            throw std::runtime_error{"Unsupported n-gram size"};
+    }
+
+    // Строки добавляются по возрастанию номеров, как при вставке в базу
+    void Insert(std::string_view iTitle, RowId iRow) {
+        grams_.clear();
+        CollectGrams(iTitle, grams_);
+        for (uint64_t gram : grams_)
+            postings_[gram].Append(iRow);
+    }
+
+    void Clear() noexcept { postings_.clear(); }
+
+    size_t GetGramSize() const noexcept { return gram_size_; }
+    size_t GetGramCount() const noexcept { return postings_.size(); }
+    size_t GetPostingBytes() const noexcept {
+        size_t res = 0;
+        for (const auto &[gram, list] : postings_)
+            res += list.GetBytes();
+        return res;
+    }
+
+    // Строки, содержащие все n-граммы запроса без учёта регистра. Для запроса короче n
+    // индекс ничего не отсекает - вызывающий должен проверить все строки
+    std::optional<std::vector<RowId>> Candidates(std::string_view iQuery) const {
+        if (iQuery.size() < gram_size_)
+            return std::nullopt;
+        std::vector<uint64_t> grams;
+        CollectGrams(iQuery, grams);
+
+        std::vector<const details::PostingList *> lists;
+        lists.reserve(grams.size());
+        for (uint64_t gram : grams) {
+            auto it = postings_.find(gram);
+            if (it == postings_.end())
+                return std::vector<RowId>{};
+            lists.push_back(&it->second);
+        }
+        // Пересечение начинается с самого короткого списка
+        std::ranges::sort(lists, {}, &details::PostingList::size);
+        std::vector<RowId> res = lists.front()->Decode();
+        for (size_t i = 1; i < lists.size() && !res.empty(); ++i)
+            lists[i]->IntersectInto(res);
+        return res;
+    }
+
+private:
+    void CollectGrams(std::string_view iText, std::vector<uint64_t> &oGrams) const {
+        for (size_t pos = 0; pos + gram_size_ <= iText.size(); ++pos) {
+            uint64_t gram = 0;
+            for (size_t i = 0; i < gram_size_; ++i)
+                gram = gram << 8 | static_cast<uint8_t>(details::FoldAscii(iText[pos + i]));
+            oGrams.push_back(gram);
+        }
+        std::ranges::sort(oGrams);
+        oGrams.erase(std::unique(oGrams.begin(), oGrams.end()), oGrams.end());
+    }
+
+    size_t gram_size_;
+    std::unordered_map<uint64_t, details::PostingList> postings_;
+    std::vector<uint64_t> grams_;
+};
+
+namespace details {
+// Оценка совпадения iQuery в названии или nullopt, если совпадения нет
+inline std::optional<double> ScoreTitle(std::string_view iTitle, std::string_view iQuery, std::string_view iFolded,
+                                        const TitleSearchOptions &iOpt) {
+    auto find = [&](size_t from) {
+        return iOpt.case_sensitive ? iTitle.find(iQuery, from) : FindFolded(iTitle, iFolded, from);
+    };
+    size_t pos = find(0);
+    if (pos == std::string_view::npos || (iOpt.mode == TitleMatchMode::Prefix && pos != 0))
+        return std::nullopt;
+
+    double rank = 1.;
+    if (pos == 0) {
+        rank = 3.;
+    } else {
+        for (; pos != std::string_view::npos; pos = find(pos + 1))
+            if (!IsWordChar(iTitle[pos - 1])) {
+                rank = 2.;
+                break;
+            }
+    }
+    return rank + static_cast<double>(iQuery.size()) / static_cast<double>(std::max<size_t>(1, iTitle.size()));
+}
+}  // namespace details
+
+// Поиск по названиям базы. С включённым индексом названий проверяются только кандидаты из индекса,
+// без него - все книги. Результат упорядочен по убыванию оценки, при равенстве - по номеру строки
+template <typename Db>
+    requires requires(const Db &db) {
+        db.GetTitleIndex();
+        db.GetBooks();
+        db.IsErased(RowId{});
+    }
+std::vector<TitleMatch> searchTitles(const Db &iDb, std::string_view iQuery, const TitleSearchOptions &iOpt = {}) {
+    BOOKDB_METRIC_TIMER(Filter);
+    std::string folded(iQuery);
+    std::ranges::transform(folded, folded.begin(), details::FoldAscii);
+
+    const auto &books = iDb.GetBooks();
+    std::vector<TitleMatch> res;
+    auto check = [&](RowId row) {
+        if (iDb.IsErased(row))
+            return;
+        const std::string_view title = books[row].title;
+        if (auto score = details::ScoreTitle(title, iQuery, folded, iOpt))
+            res.push_back({row, *score});
+    };
+
+    std::optional<std::vector<RowId>> candidates;
+    if (const TitleIndex *index = iDb.GetTitleIndex())
+        candidates = index->Candidates(iQuery);
+    if (candidates) {
+        for (RowId row : *candidates)
+            check(row);
+    } else {
+        for (RowId row = 0; row < books.size(); ++row)
+            check(row);
+    }
+    BOOKDB_METRIC_ADD(FilterCalls, 1);
+    BOOKDB_METRIC_ADD(RowsScanned, candidates ? candidates->size() : books.size());
+    BOOKDB_METRIC_ADD(RowsSelected, res.size());
+
+    auto better = [](const TitleMatch &lhv, const TitleMatch &rhv) {
+        return lhv.score != rhv.score ? lhv.score > rhv.score : lhv.row < rhv.row;
+    };
+    if (iOpt.limit && iOpt.limit < res.size()) {
+        std::ranges::partial_sort(res, res.begin() + iOpt.limit, better);
+        res.resize(iOpt.limit);
+    } else {
+        std::ranges::sort(res, better);
+    }
+    return res;
+}
+}  // namespace bookdb
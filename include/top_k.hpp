@@ -0,0 +1,156 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <ranges>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "book_database.hpp"
+#include "concepts.hpp"
+#include "metrics.hpp"
+#include "order_index.hpp"
+#include "thread_pool.hpp"
+
+// Top-K без перестановки исходных данных. Каждый поток держит ограниченную кучу
+// из K номеров строк, затем кандидаты всех частей сливаются в окончательный ответ.
+// При равенстве по компаратору выше оказывается строка с меньшим номером,
+// поэтому результат не зависит от степени параллелизма
+namespace bookdb {
+namespace details {
+// Колоночное хранилище отдаёт ключ компаратора отдельной колонкой: сравнение читает одно число
+// или строку, а не собирает из прокси-ссылки Book со строками
+template <typename Comparator, typename R>
+concept HasKeyColumn =
+    OrderIndexable<Comparator> && requires(const R &iRange) { OrderKey<Comparator>::Column(iRange); };
+
+template <typename Comparator, typename R>
+struct KeyColumnOf {
+    using type = std::nullptr_t;
+};
+
+template <typename Comparator, typename R>
+    requires HasKeyColumn<Comparator, R>
+struct KeyColumnOf<Comparator, R> {
+    using type = std::span<const typename OrderKey<Comparator>::Key>;
+};
+
+// Результат - номера строк, а части сканируются параллельно по смещениям, поэтому диапазон
+// должен быть с произвольным доступом
+template <std::ranges::random_access_range R, typename Comparator>
+class TopKSelector {
+public:
+    TopKSelector(const R &iRange, Comparator iComp) : range_(iRange), comp_(std::move(iComp)) {
+        if constexpr (HasKeyColumn<Comparator, R>)
+            keys_ = OrderKey<Comparator>::Column(iRange);
+    }
+
+    // Порядок "лучше": сначала по компаратору, при равенстве - по номеру строки
+    bool Better(size_t lhv, size_t rhv) const {
+        if (Less(lhv, rhv))
+            return true;
+        if (Less(rhv, lhv))
+            return false;
+        return lhv < rhv;
+    }
+
+    // Ограниченная куча: на вершине худший из отобранных, новый кандидат вытесняет его, если лучше
+    // Строки, для которых iSkip(row) истинно, в отбор не попадают
+    template <typename Skip>
+    void Scan(size_t iBegin, size_t iEnd, size_t iK, const Skip &iSkip, std::vector<size_t> &oHeap) const {
+        auto better = [this](size_t l, size_t r) { return Better(l, r); };
+        oHeap.reserve(iK);
+        for (size_t i = iBegin; i < iEnd; ++i) {
+            if (iSkip(i))
+                continue;
+            if (oHeap.size() < iK) {
+                oHeap.push_back(i);
+                std::push_heap(oHeap.begin(), oHeap.end(), better);
+            } else if (Better(i, oHeap.front())) {
+                std::pop_heap(oHeap.begin(), oHeap.end(), better);
+                oHeap.back() = i;
+                std::push_heap(oHeap.begin(), oHeap.end(), better);
+            }
+        }
+    }
+
+    void SortBestFirst(std::vector<size_t> &ioRows, size_t iK) const {
+        auto better = [this](size_t l, size_t r) { return Better(l, r); };
+        const auto middle = ioRows.begin() + static_cast<std::ptrdiff_t>(std::min(iK, ioRows.size()));
+        std::partial_sort(ioRows.begin(), middle, ioRows.end(), better);
+        ioRows.erase(middle, ioRows.end());
+    }
+
+private:
+    bool Less(size_t lhv, size_t rhv) const {
+        if constexpr (HasKeyColumn<Comparator, R>)
+            return typename OrderKey<Comparator>::Compare{}(keys_[lhv], keys_[rhv]);
+        else
+            return comp_(At(lhv), At(rhv));
+    }
+
+    decltype(auto) At(size_t i) const { return std::ranges::begin(range_)[static_cast<std::ptrdiff_t>(i)]; }
+
+    const R &range_;
+    Comparator comp_;
+    typename KeyColumnOf<Comparator, R>::type keys_{};
+};
+
+template <std::ranges::random_access_range R, typename Comparator, typename Skip>
+std::vector<size_t> selectTopK(const R &iRange, size_t N, Comparator comp, const Parallelism &iPar,
+                               const Skip &iSkip) {
+    BOOKDB_METRIC_TIMER(TopK);
+    BOOKDB_METRIC_ADD(TopKCalls, 1);
+
+    TopKSelector<R, Comparator> selector(iRange, std::move(comp));
+    if (N == 0)
+        return {};
+
+    const auto size = static_cast<size_t>(std::ranges::size(iRange));
+    std::vector<std::vector<size_t>> partials(ParallelPartCount(size, iPar));
+    ParallelFor(size, iPar,
+                [&](size_t part, size_t begin, size_t end) { selector.Scan(begin, end, N, iSkip, partials[part]); });
+
+    std::vector<size_t> res = std::move(partials.front());
+    for (size_t part = 1; part < partials.size(); ++part)
+        res.insert(res.end(), partials[part].begin(), partials[part].end());
+    selector.SortBestFirst(res, N);
+    return res;
+}
+}  // namespace details
+
+// Номера N лучших по компаратору элементов диапазона, от лучшего к худшему. Диапазон не изменяется
+template <std::ranges::random_access_range R, typename Comparator>
+std::vector<size_t> topKIndices(const R &iRange, size_t N, Comparator comp, const Parallelism &iPar = {}) {
+    if (static_cast<size_t>(std::ranges::size(iRange)) < N)
+        throw std::runtime_error{"iRange.size() < N"};
+    return details::selectTopK(iRange, N, std::move(comp), iPar, [](size_t) { return false; });
+}
+
+// Удалённые строки пропускаются, N не может превышать число живых книг
+template <BookContainerLike T, BookComparator Comparator>
+std::vector<RowId> getTopKRowIds(const BookDatabase<T> &iCont, size_t N, Comparator comp,
+                                 const Parallelism &iPar = {}) {
+    if (iCont.GetLiveCount() < N)
+        throw std::runtime_error{"iCont.GetLiveCount() < N"};
+    return details::selectTopK(iCont.GetBooks(), N, std::move(comp), iPar,
+                               [&iCont](RowId iRow) { return iCont.IsErased(iRow); });
+}
+
+// Ссылки остаются действительными, пока в базу не добавляются книги
+template <BookContainerLike T, BookComparator Comparator>
+    requires std::is_lvalue_reference_v<typename T::reference>
+std::vector<std::reference_wrapper<const Book>> getTopKBy(const BookDatabase<T> &iCont, size_t N, Comparator comp,
+                                                          const Parallelism &iPar = {}) {
+    const auto rows = getTopKRowIds(iCont, N, std::move(comp), iPar);
+
+    std::vector<std::reference_wrapper<const Book>> res;
+    res.reserve(rows.size());
+    for (RowId row : rows)
+        res.emplace_back(iCont.GetBooks()[row]);
+    return res;
+}
+}  // namespace bookdb
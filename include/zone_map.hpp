@@ -0,0 +1,235 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "book.hpp"
+#include "concepts.hpp"
+#include "filters.hpp"
+#include "selection_bitmap.hpp"
+
+namespace bookdb {
+
+// Что сводка блока говорит о предикате: ни одна строка не подходит, подходят некоторые или все
+enum class ZoneMatch { None, Partial, All };
+
+// Сводка по блоку строк: границы числовых полей, маска встреченных жанров и суммы рейтингов
+// по жанрам - агрегаты по целиком подходящему блоку не читают его строки
+struct Zone {
+    size_t rows = 0;
+    int min_year = std::numeric_limits<int>::max();
+    int max_year = std::numeric_limits<int>::min();
+    double min_rating = std::numeric_limits<double>::infinity();
+    double max_rating = -std::numeric_limits<double>::infinity();
+    int min_read_count = std::numeric_limits<int>::max();
+    int max_read_count = std::numeric_limits<int>::min();
+    uint32_t genre_mask = 0;
+    std::array<std::pair<double, size_t>, kGenreCount> genre_ratings{};
+
+    static constexpr uint32_t GenreBit(Genre iGenre) noexcept { return uint32_t{1} << details::GenreSlot(iGenre); }
+
+    template <typename B>
+    void Insert(const B &iBook) noexcept {
+        ++rows;
+        Cover(iBook);
+    }
+
+    // Удалённая книга уходит из сумм, а границы остаются прежними: они лишь шире, чем нужно
+    template <typename B>
+    void Erase(const B &iBook) noexcept {
+        auto &[totalRating, count] = genre_ratings[details::GenreSlot(iBook.genre)];
+        totalRating -= iBook.rating;
+        --count;
+    }
+
+    template <typename B>
+    void Update(const B &iBefore, const B &iAfter) noexcept {
+        Erase(iBefore);
+        Cover(iAfter);
+    }
+
+    // Расширяет границы под книгу и добавляет её в суммы
+    template <typename B>
+    void Cover(const B &iBook) noexcept {
+        min_year = std::min(min_year, iBook.year);
+        max_year = std::max(max_year, iBook.year);
+        min_rating = std::min(min_rating, iBook.rating);
+        max_rating = std::max(max_rating, iBook.rating);
+        min_read_count = std::min(min_read_count, iBook.read_count);
+        max_read_count = std::max(max_read_count, iBook.read_count);
+        genre_mask |= GenreBit(iBook.genre);
+        auto &[totalRating, count] = genre_ratings[details::GenreSlot(iBook.genre)];
+        totalRating += iBook.rating;
+        ++count;
+    }
+};
+
+namespace details {
+// Предикаты, для которых сводка блока может что-то исключить
+template <typename P>
+inline constexpr bool IsZonePrunable =
+    std::same_as<P, pred::YearBetween> || std::same_as<P, pred::RatingAbove> || std::same_as<P, pred::GenreIs>;
+template <typename... Ps>
+inline constexpr bool IsZonePrunable<pred::AllOf<Ps...>> = (IsZonePrunable<Ps> || ...);
+template <typename... Ps>
+inline constexpr bool IsZonePrunable<pred::AnyOf<Ps...>> = (IsZonePrunable<Ps> && ...);
+
+// all_of подходит не лучше худшего конъюнкта, any_of - не хуже лучшего дизъюнкта.
+// Про остальные предикаты сводка ничего не знает
+template <typename P>
+ZoneMatch CheckZone(const Zone &iZone, const P &iPred) noexcept {
+    if (iZone.rows == 0)
+        return ZoneMatch::None;
+    if constexpr (std::same_as<P, pred::YearBetween>) {
+        if (iZone.max_year < iPred.start || iZone.min_year > iPred.end)
+            return ZoneMatch::None;
+        return iPred.start <= iZone.min_year && iZone.max_year <= iPred.end ? ZoneMatch::All : ZoneMatch::Partial;
+    } else if constexpr (std::same_as<P, pred::RatingAbove>) {
+        if (!(iZone.max_rating > iPred.min_rating))
+            return ZoneMatch::None;
+        return iZone.min_rating > iPred.min_rating ? ZoneMatch::All : ZoneMatch::Partial;
+    } else if constexpr (std::same_as<P, pred::GenreIs>) {
+        const uint32_t bit = Zone::GenreBit(iPred.genre);
+        if (!(iZone.genre_mask & bit))
+            return ZoneMatch::None;
+        return iZone.genre_mask == bit ? ZoneMatch::All : ZoneMatch::Partial;
+    } else if constexpr (IsAllOf<P>) {
+        return std::apply([&](const auto &...p) { return std::min({ZoneMatch::All, CheckZone(iZone, p)...}); },
+                          iPred.preds);
+    } else if constexpr (IsAnyOf<P>) {
+        return std::apply([&](const auto &...p) { return std::max({ZoneMatch::None, CheckZone(iZone, p)...}); },
+                          iPred.preds);
+    } else {
+        return ZoneMatch::Partial;
+    }
+}
+}  // namespace details
+
+// Сводки по блокам из iBlockSize подряд идущих строк, обновляются при добавлении, удалении
+// и изменении строк. Удалённые строки блок по-прежнему покрывает, их отсекает маска удалённых.
+// Фильтры и агрегаты пропускают блоки, в которых предикат заведомо не выполняется,
+// и не проверяют построчно блоки, где он выполняется целиком. Отсечение тем сильнее,
+// чем уже диапазоны значений в блоках, - см. BookDatabase::ClusterBy
+class ZoneMap {
+public:
+    static constexpr size_t kDefaultBlockSize = 4096;
+
+    // Размер блока кратен слову маски, чтобы блок занимал целые слова SelectionBitmap
+    explicit ZoneMap(size_t iBlockSize = kDefaultBlockSize) : block_size_(iBlockSize) {
+        if (iBlockSize == 0 || iBlockSize % SelectionBitmap::kWordBits)
+            throw std::runtime_error{"Zone block size must be a positive multiple of 64"};
+    }
+
+    template <typename Books>
+    ZoneMap(const Books &iBooks, size_t iBlockSize) : ZoneMap(iBlockSize) {
+        RowId row = 0;
+        for (const auto &book : iBooks)
+            Insert(book, row++);
+    }
+
+    // Строки добавляются по возрастанию номеров, как при вставке в базу
+    template <typename B>
+    void Insert(const B &iBook, RowId iRow) {
+        if (iRow / block_size_ >= zones_.size())
+            zones_.emplace_back();
+        zones_.back().Insert(iBook);
+        rows_ = iRow + 1;
+    }
+
+    template <typename B>
+    void Erase(const B &iBook, RowId iRow) noexcept {
+        zones_[iRow / block_size_].Erase(iBook);
+    }
+
+    template <typename B>
+    void Update(const B &iBefore, const B &iAfter, RowId iRow) noexcept {
+        zones_[iRow / block_size_].Update(iBefore, iAfter);
+    }
+
+    void Clear() noexcept {
+        zones_.clear();
+        rows_ = 0;
+    }
+
+    size_t GetBlockSize() const noexcept { return block_size_; }
+    size_t GetBlockCount() const noexcept { return zones_.size(); }
+    const Zone &GetZone(size_t iBlock) const noexcept { return zones_[iBlock]; }
+    size_t size() const noexcept { return rows_; }
+
+    // iFunc(const Zone &, RowId begin, RowId end, ZoneMatch) для блоков, где iPred может выполниться,
+    // по возрастанию номеров строк
+    template <typename P, typename F>
+    void ForEachCandidate(const P &iPred, F &&iFunc) const {
+        for (size_t block = 0; block < zones_.size(); ++block) {
+            const ZoneMatch match = details::CheckZone(zones_[block], iPred);
+            if (match != ZoneMatch::None)
+                iFunc(zones_[block], block * block_size_, std::min(rows_, (block + 1) * block_size_), match);
+        }
+    }
+
+    // Сколько строк придётся проверить построчно: строки блоков с частичным совпадением
+    template <typename P>
+    size_t CountPartialRows(const P &iPred) const {
+        size_t res = 0;
+        for (const Zone &zone : zones_)
+            res += details::CheckZone(zone, iPred) == ZoneMatch::Partial ? zone.rows : 0;
+        return res;
+    }
+
+private:
+    size_t block_size_;
+    size_t rows_ = 0;
+    std::vector<Zone> zones_;
+};
+
+namespace details {
+// Над колонками векторное ядро по всей базе обгоняет построчную проверку,
+// поэтому сводки используются, только если построчно остаётся проверить меньше этой доли строк
+inline constexpr double kMaxZonePartialShare = 0.5;
+
+// Маска строк, для которых выполняется iRowPred, по сводкам iZones для iPred (iRowPred должен
+// быть ему эквивалентен, например планом запроса). Отброшенные блоки не читаются, целиком
+// подходящие отмечаются без проверки строк. nullopt, если сводки не помогут; иначе
+// в oScanned - число проверенных построчно строк
+template <BookContainerLike C, typename P, typename R>
+std::optional<SelectionBitmap> SelectZoned(const C &iBooks, const ZoneMap &iZones, const P &iPred,
+                                           const R &iRowPred, size_t &oScanned) {
+    if constexpr (!IsZonePrunable<P>) {
+        return std::nullopt;
+    } else {
+        if (iZones.size() != iBooks.size())
+            return std::nullopt;
+        if constexpr (ColumnarBookContainerLike<C>)
+            if (iZones.CountPartialRows(iPred) > kMaxZonePartialShare * static_cast<double>(iBooks.size()))
+                return std::nullopt;
+
+        SelectionBitmap res(iBooks.size());
+        auto words = res.GetWords();
+        size_t scanned = 0;
+        iZones.ForEachCandidate(iPred, [&](const Zone &, RowId begin, RowId end, ZoneMatch match) {
+            if (match == ZoneMatch::All) {
+                std::fill(words.begin() + begin / SelectionBitmap::kWordBits,
+                          words.begin() + end / SelectionBitmap::kWordBits, ~SelectionBitmap::Word{0});
+                for (RowId row = end - end % SelectionBitmap::kWordBits; row < end; ++row)
+                    res.Set(row);
+                return;
+            }
+            scanned += end - begin;
+            for (RowId row = begin; row < end; ++row)
+                if (iRowPred(iBooks[row]))
+                    res.Set(row);
+        });
+        oScanned = scanned;
+        return res;
+    }
+}
+}  // namespace details
+}  // namespace bookdb
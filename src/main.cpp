@@ -3,7 +3,9 @@
 #include "book_database.hpp"
 #include "comparators.hpp"
 #include "filters.hpp"
+#include "query_planner.hpp"
 #include "statsistics.hpp"
+#include "top_k.hpp"
 
 using namespace bookdb;
 
@@ -24,12 +26,17 @@ int main() {
     db.EmplaceBack("Lord of the Flies", "William Golding", 1954, Genre::Fiction, 4.2, 89);
     std::print("Books: {}\n\n", db);
 
-    // Sorts
-    std::sort(db.begin(), db.end(), comp::LessByAuthor{});
-    std::print("Books sorted by author: {}\n\n==================\n", db);
+    // Sorts: индексы порядка выдают книги упорядоченными, не переставляя саму базу
+    db.EnableOrderIndex<comp::LessByAuthor>();
+    db.EnableOrderIndex<comp::LessByPopularity>();
+    auto printBook = [&db](RowId row) { std::print("- {}\n", db.GetBooks()[row]); };
+    std::print("Books sorted by author:\n");
+    db.GetOrderIndex<comp::LessByAuthor>()->ForEach(printBook);
+    std::print("\n==================\n");
 
-    std::sort(db.begin(), db.end(), comp::LessByPopularity{});
-    std::print("Books sorted by popularity: {}\n\n==================\n", db);
+    std::print("Books sorted by popularity:\n");
+    db.GetOrderIndex<comp::LessByPopularity>()->ForEach(printBook);
+    std::print("\n==================\n");
 
     // Author histogram
     auto histogram = buildAuthorHistogramFlat(db);
@@ -48,15 +55,15 @@ int main() {
     std::for_each(filtered.cbegin(), filtered.cend(), [](const auto &v) { std::print("{}\n", v.get()); });
 
     // Top 3 books
-    [[maybe_unused]] auto topBooks = getTopNBy(db, 3, comp::GreaterByRating{});
+    auto topBooks = getTopKBy(db, 3, comp::GreaterByRating{});
     std::print("\n\nTop 3 books by rating:\n");
-    std::for_each(topBooks.cbegin(), topBooks.cend(), [](const auto &v) { std::print("{}\n", v); });
+    std::for_each(topBooks.cbegin(), topBooks.cend(), [](const auto &v) { std::print("{}\n", v.get()); });
 
-    [[maybe_unused]] auto orwellBookIt =
-        std::find_if(db.begin(), db.end(), [](const auto &v) { return v.author == "George Orwell"; });
-    if (orwellBookIt != db.end()) {
-        std::print("\n\nTransparent lookup by authors. Found Orwell's book: {}\n", *orwellBookIt);
-    }
+    // Вторичные индексы строятся по текущему содержимому и дальше поддерживаются при вставке
+    db.EnableIndexes();
+    auto orwellBooks = filterBooks(db, AuthorIs("George Orwell"));
+    std::print("\n\nIndexed lookup by authors. Found Orwell's books:\n");
+    std::for_each(orwellBooks.cbegin(), orwellBooks.cend(), [](const auto &v) { std::print("{}\n", v.get()); });
 
     return 0;
 }
\ No newline at end of file
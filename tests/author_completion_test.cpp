@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+
+#include "author_completion.hpp"
+#include "book_database.hpp"
+#include "catalog_generator.hpp"
+#include "columnar_book_container.hpp"
+
+using namespace bookdb;
+
+class AuthorCompletionTest : public ::testing::Test {
+protected:
+    BookDatabase<std::vector<Book>> db;
+
+    void SetUp() override {
+        db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+        db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+        db.EmplaceBack("Middlemarch", "George Eliot", 1871, Genre::Fiction, 4.0, 200);
+        db.EmplaceBack("Silas Marner", "George Eliot", 1861, Genre::Fiction, 3.9, 50);
+        db.EmplaceBack("Pygmalion", "George Bernard Shaw", 1913, Genre::Fiction, 4.1, 250);
+        db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+    }
+};
+
+TEST_F(AuthorCompletionTest, ExactAndPrefixLookup) {
+    const auto completion = buildAuthorCompletion(db);
+    ASSERT_EQ(completion.size(), 4);
+
+    EXPECT_EQ(completion.Find("George Eliot"), db.GetAuthors().Find("George Eliot"));
+    EXPECT_EQ(completion.Find(std::string("F. Scott Fitzgerald")), db.GetAuthors().Find("F. Scott Fitzgerald"));
+    EXPECT_EQ(completion.Find("George"), kNoAuthorId);
+
+    std::vector<std::string_view> names;
+    for (AuthorId id : completion.WithPrefix("George"))
+        names.push_back(db.GetAuthors().GetName(id));
+    EXPECT_EQ(names, (std::vector<std::string_view>{"George Bernard Shaw", "George Eliot", "George Orwell"}));
+    EXPECT_TRUE(completion.WithPrefix("Zed").empty());
+    EXPECT_EQ(completion.WithPrefix("").size(), 4);
+}
+
+TEST_F(AuthorCompletionTest, CompletionsRankedByReadCount) {
+    const auto completion = buildAuthorCompletion(db);
+
+    const auto top = completion.Complete("Geo", 2);
+    ASSERT_EQ(top.size(), 2);
+    // Orwell 333 и Shaw 250 против Eliot 250: при равенстве раньше идёт имя
+    EXPECT_EQ(top[0].name, "George Orwell");
+    EXPECT_EQ(top[0].read_count, 333);
+    EXPECT_EQ(top[1].name, "George Bernard Shaw");
+    EXPECT_EQ(completion.Complete("Geo", 10).size(), 3);
+    EXPECT_TRUE(completion.Complete("x", 10).empty());
+}
+
+TEST(AuthorCompletionCatalogTest, MatchesBruteForce) {
+    BookDatabase<ColumnarBookContainer> db;
+    generateCatalog(db, CatalogOptions{.rows = 5000, .authors = 500});
+    const auto completion = buildAuthorCompletion(db);
+
+    std::vector<uint64_t> readCounts(db.GetAuthors().size());
+    for (const Book book : db)
+        readCounts[book.author_id] += book.read_count;
+
+    for (std::string_view prefix : {"Author 1", "Author 4", "Author 99", ""}) {
+        std::vector<AuthorId> expected;
+        for (AuthorId id = 0; id < db.GetAuthors().size(); ++id)
+            if (db.GetAuthors().GetName(id).starts_with(prefix))
+                expected.push_back(id);
+        std::ranges::sort(expected, [&](AuthorId l, AuthorId r) {
+            return readCounts[l] != readCounts[r] ? readCounts[l] > readCounts[r]
+                                                  : db.GetAuthors().GetName(l) < db.GetAuthors().GetName(r);
+        });
+        expected.resize(std::min<size_t>(expected.size(), 5));
+
+        std::vector<AuthorId> actual;
+        for (const auto &entry : completion.Complete(prefix, 5))
+            actual.push_back(entry.id);
+        EXPECT_EQ(actual, expected) << prefix;
+    }
+}
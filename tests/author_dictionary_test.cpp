@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <ranges>
+#include <sstream>
+
+#include "book_database.hpp"
+#include "columnar_book_container.hpp"
+#include "comparators.hpp"
+#include "parallel_statistics.hpp"
+#include "statsistics.hpp"
+
+using namespace bookdb;
+
+class AuthorDictionaryTest : public ::testing::Test {
+protected:
+    BookDatabase<std::vector<Book>> db;
+
+    void SetUp() override {
+        db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+        db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+        db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+        db.EmplaceBack("Brave New World", "Aldous Huxley", 1932, Genre::SciFi, 4.5, 98);
+    }
+};
+
+TEST_F(AuthorDictionaryTest, DenseIdsInOrderOfAppearance) {
+    const auto &authors = db.GetAuthors();
+    ASSERT_EQ(authors.size(), 3);
+    EXPECT_EQ(authors.Find("George Orwell"), 0);
+    EXPECT_EQ(authors.Find("F. Scott Fitzgerald"), 1);
+    EXPECT_EQ(authors.Find("Aldous Huxley"), 2);
+    EXPECT_EQ(authors.Find("Harper Lee"), kNoAuthorId);
+
+    for (const auto &book : db)
+        EXPECT_EQ(authors.GetName(book.author_id), book.author);
+    EXPECT_EQ(db.GetBooks()[0].author_id, db.GetBooks()[2].author_id);
+}
+
+TEST_F(AuthorDictionaryTest, RankSortMatchesStringSort) {
+    auto byName = db.GetBooks();
+    std::stable_sort(byName.begin(), byName.end(), comp::LessByAuthor{});
+
+    const auto ranks = db.GetAuthors().BuildRanks();
+    std::stable_sort(db.begin(), db.end(), comp::LessByAuthorRank{ranks});
+    EXPECT_TRUE(std::equal(db.begin(), db.end(), byName.begin(), byName.end()));
+
+    // Автор, добавленный после построения рангов, идёт последним
+    db.EmplaceBack("Brave New World", "Aaron Newcomer", 1932, Genre::SciFi, 4.5, 98);
+    const comp::LessByAuthorRank byRank{ranks};
+    EXPECT_TRUE(byRank(db.GetBooks()[0], db.GetBooks().back()));
+    EXPECT_FALSE(byRank(db.GetBooks().back(), db.GetBooks()[0]));
+}
+
+TEST_F(AuthorDictionaryTest, DenseHistogram) {
+    const auto dense = buildAuthorHistogramDense(db);
+    ASSERT_EQ(dense.size(), 3);
+    EXPECT_EQ(dense[db.GetAuthors().Find("George Orwell")], 2);
+    EXPECT_EQ(buildAuthorHistogramDenseParallel(db, {.threads = 2, .min_part_size = 1}), dense);
+
+    auto histogram = buildAuthorHistogramFlat(db);
+    ASSERT_EQ(histogram.size(), 3);
+    EXPECT_EQ(histogram.begin()->first, "Aldous Huxley");
+    EXPECT_EQ(histogram["George Orwell"], 2);
+}
+
+TEST_F(AuthorDictionaryTest, ColumnarKeepsIds) {
+    BookDatabase<ColumnarBookContainer> columnar;
+    for (const auto &book : db)
+        columnar.PushBack(book);
+
+    const auto ids = columnar.GetBooks().GetAuthorIds();
+    ASSERT_EQ(ids.size(), db.size());
+    EXPECT_EQ(ids[0], ids[2]);
+    EXPECT_EQ(Book(columnar.GetBooks()[1]).author_id, ids[1]);
+    EXPECT_EQ(buildAuthorHistogramDense(columnar), buildAuthorHistogramDense(db));
+}
+
+TEST_F(AuthorDictionaryTest, BulkInsertMatchesPushBack) {
+    const std::vector<Book> batch = {{"Homage to Catalonia", "George Orwell", 1938, Genre::NonFiction, 4.2, 60},
+                                     {"Island", "Aldous Huxley", 1962, Genre::Fiction, 3.9, 30},
+                                     {"To Kill a Mockingbird", "Harper Lee", 1960, Genre::Fiction, 4.8, 200},
+                                     {"Go Set a Watchman", "Harper Lee", 2015, Genre::Fiction, 3.4, 40}};
+    BookDatabase<std::vector<Book>> single = db;
+    for (const auto &book : batch)
+        single.PushBack(book);
+
+    db.EnableAggregates();
+    db.BulkInsert(batch);
+    ASSERT_EQ(db.size(), single.size());
+    EXPECT_TRUE(std::ranges::equal(db.GetAuthors(), single.GetAuthors()));
+    for (size_t row = 0; row < db.size(); ++row) {
+        EXPECT_EQ(db.GetBooks()[row], single.GetBooks()[row]);
+        EXPECT_EQ(db.GetBooks()[row].author_id, single.GetBooks()[row].author_id);
+        EXPECT_EQ(db.GetBooks()[row].author.data(), db.GetAuthors().GetName(db.GetBooks()[row].author_id).data());
+    }
+    EXPECT_NE(db.GetBooks()[4].title.data(), batch[0].title.data());
+    EXPECT_EQ(db.GetAggregates()->GetAuthorCount(db.GetAuthors().Find("Harper Lee")), 2);
+}
+
+TEST_F(AuthorDictionaryTest, BulkInsertFromViews) {
+    BookDatabase<ColumnarBookContainer> columnar;
+    columnar.BulkInsert(db.GetBooks() | std::views::reverse);
+    ASSERT_EQ(columnar.size(), db.size());
+    EXPECT_EQ(columnar.GetAuthors().Find("Aldous Huxley"), 0);
+    EXPECT_EQ(Book(columnar.GetBooks()[0]).title, "Brave New World");
+
+    // Однопроходный диапазон
+    BookDatabase<std::vector<Book>> copy;
+    std::istringstream years("1949 1925");
+    copy.BulkInsert(std::views::istream<int>(years) | std::views::transform([&](int year) {
+                        return *std::ranges::find(db, year, &Book::year);
+                    }));
+    ASSERT_EQ(copy.size(), 2);
+    EXPECT_EQ(copy.GetBooks()[1].author, "F. Scott Fitzgerald");
+    EXPECT_EQ(copy.GetAuthors().size(), 2);
+}
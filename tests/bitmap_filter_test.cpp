@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "bitmap_filter.hpp"
+#include "book_database.hpp"
+#include "columnar_book_container.hpp"
+#include "filters.hpp"
+
+using namespace bookdb;
+
+class BitmapFilterTest : public ::testing::Test {
+protected:
+    BookDatabase<ColumnarBookContainer> columns;
+    BookDatabase<std::vector<Book>> rows;
+
+    void SetUp() override {
+        // Размер специально не кратен 64, чтобы проверить хвост маски
+        std::mt19937 gen{42};
+        std::uniform_int_distribution<int> year(1800, 2020);
+        std::uniform_int_distribution<int> genre(0, static_cast<int>(Genre::Unknown));
+        std::uniform_real_distribution<double> rating(0., 5.);
+        for (int i = 0; i < 1000; ++i) {
+            Book book{"Title", "Author", year(gen), static_cast<Genre>(genre(gen)), rating(gen), i};
+            columns.PushBack(book);
+            rows.PushBack(book);
+        }
+    }
+
+    template <typename P>
+    std::vector<size_t> Expected(const P &iPred) const {
+        std::vector<size_t> res;
+        for (size_t i = 0; i < rows.size(); ++i)
+            if (iPred(rows.GetBooks()[i]))
+                res.push_back(i);
+        return res;
+    }
+};
+
+TEST_F(BitmapFilterTest, SingleKernelsMatchScalar) {
+    EXPECT_EQ(filterBookIds(columns, YearBetween(1900, 1999)), Expected(YearBetween(1900, 1999)));
+    EXPECT_EQ(filterBookIds(columns, RatingAbove(4.5)), Expected(RatingAbove(4.5)));
+    EXPECT_EQ(filterBookIds(columns, GenreIs(Genre::SciFi)), Expected(GenreIs(Genre::SciFi)));
+}
+
+TEST_F(BitmapFilterTest, CombinatorsMatchScalar) {
+    auto filter = any_of(all_of(YearBetween(1900, 1999), RatingAbove(4.)), GenreIs(Genre::Mystery));
+
+    EXPECT_EQ(filterBookIds(columns, filter), Expected(filter));
+    EXPECT_EQ(filterBookIds(rows, filter), Expected(filter));
+}
+
+TEST_F(BitmapFilterTest, CountOnlyMatchesScalar) {
+    auto filter = all_of(YearBetween(1900, 1999), RatingAbove(4.));
+
+    EXPECT_EQ(countBooks(columns, filter), Expected(filter).size());
+    EXPECT_EQ(countBooks(rows, filter), Expected(filter).size());
+}
+
+TEST_F(BitmapFilterTest, OpaquePredicateFallback) {
+    auto filter = all_of(RatingAbove(2.), [](const Book &b) { return b.read_count % 3 == 0; });
+
+    EXPECT_EQ(filterBookIds(columns, filter), Expected(filter));
+}
+
+TEST_F(BitmapFilterTest, BitmapOperations) {
+    auto bitmap = selectBooks(columns, YearBetween(3000, 4000));
+    EXPECT_FALSE(bitmap.Any());
+    EXPECT_EQ(bitmap.size(), columns.size());
+
+    bitmap.Flip();
+    EXPECT_EQ(bitmap.Count(), columns.size());
+}
+
+// Выборка по базе идёт через планировщик, даже если подключён только bitmap_filter.hpp
+TEST_F(BitmapFilterTest, DatabaseOverloadsUsePlanner) {
+    rows.EnableIndexes();
+    const auto pred = all_of(YearBetween(1900, 1902), RatingAbove(2.5));
+    EXPECT_EQ(planQuery(rows, pred).GetAccessPath(), AccessPath::Index);
+    EXPECT_EQ(filterBookIds(rows, pred), Expected(pred));
+    EXPECT_EQ(filterBooks(rows, pred).size(), Expected(pred).size());
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include "book_exporter.hpp"
+#include "book_loader.hpp"
+#include "catalog_generator.hpp"
+#include "columnar_book_container.hpp"
+
+using namespace bookdb;
+
+static_assert(GenreName(Genre::SciFi) == "SciFi");
+static_assert(GenreName(static_cast<Genre>(42)) == "Unknown");
+
+namespace {
+template <typename Db>
+std::string exportToString(const Db &iDb, const ExportOptions &iOpt) {
+    std::string res;
+    exportBooks(iDb, [&res](std::string_view iText) { res.append(iText); }, iOpt);
+    return res;
+}
+}  // namespace
+
+TEST(BookExporterTest, CsvRoundTripsThroughLoader) {
+    BookDatabase<std::vector<Book>> db;
+    db.EmplaceBack("Animal Farm, a Fairy Story", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+    db.EmplaceBack("The \"Great\" Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+    db.EmplaceBack("Erased", "Nobody", 2000, Genre::Mystery, 1.0, 0);
+    db.EmplaceBack("Solaris", "Stanislaw Lem", 1961, Genre::SciFi, 0.1 + 0.2, 100);
+    db.Erase(2);
+
+    std::ostringstream out;
+    const auto report = exportBooks(db, out);
+    EXPECT_EQ(report.rows_written, 3);
+    EXPECT_EQ(report.bytes_written, out.str().size());
+    EXPECT_TRUE(out.str().starts_with("title,author,year,genre,rating,read_count\n"
+                                      "\"Animal Farm, a Fairy Story\",George Orwell,1945,Fiction,4.4,143\n"
+                                      "\"The \"\"Great\"\" Gatsby\","));
+
+    BookDatabase<std::vector<Book>> loaded;
+    EXPECT_EQ(loadBooks(loaded, out.str()).rows_rejected, 0);
+    ASSERT_EQ(loaded.size(), 3);
+    EXPECT_EQ(loaded.GetBooks()[0], db.GetBooks()[0]);
+    EXPECT_EQ(loaded.GetBooks()[1], db.GetBooks()[1]);
+    EXPECT_EQ(loaded.GetBooks()[2], db.GetBooks()[3]);
+}
+
+TEST(BookExporterTest, JsonLinesEscapesStrings) {
+    BookDatabase<std::vector<Book>> db;
+    db.EmplaceBack("Line\nbreak \"quoted\" \\", "Author\t1", 2001, Genre::Biography, 3.5, 7);
+    EXPECT_EQ(exportToString(db, ExportOptions{.format = ExportFormat::JsonLines}),
+              "{\"title\":\"Line\\nbreak \\\"quoted\\\" \\\\\",\"author\":\"Author\\t1\",\"year\":2001,"
+              "\"genre\":\"Biography\",\"rating\":3.5,\"read_count\":7}\n");
+}
+
+TEST(BookExporterTest, ParallelChunksKeepRowOrder) {
+    BookDatabase<ColumnarBookContainer> db;
+    generateCatalog(db, CatalogOptions{.rows = 5000, .authors = 100});
+    for (BookId id = 0; id < 5000; id += 7)
+        db.Erase(id);
+
+    for (auto format : {ExportFormat::Csv, ExportFormat::JsonLines}) {
+        const auto sequential = exportToString(db, ExportOptions{.format = format, .par = {.threads = 1}});
+        const ExportOptions small{.format = format, .chunk_rows = 97, .par = {.threads = 4, .min_part_size = 1}};
+        const auto parallel = exportToString(db, small);
+        EXPECT_EQ(parallel, sequential);
+    }
+
+    BookDatabase<std::vector<Book>> loaded;
+    const auto csv = exportToString(db, ExportOptions{.delimiter = '\t', .chunk_rows = 500});
+    loadBooks(loaded, csv, LoadOptions{.delimiter = '\t'});
+    ASSERT_EQ(loaded.size(), db.GetLiveCount());
+    EXPECT_EQ(loaded.GetBooks()[0].title, db.GetBooks()[1].title);
+}
+
+// База такие рейтинги не принимает, поэтому строки пишутся напрямую
+TEST(BookExporterTest, NonFiniteRatingIsMissingValue) {
+    const Book nan{"Void", "Nobody", 2000, Genre::Unknown, std::numeric_limits<double>::quiet_NaN(), 1};
+    const Book inf{"Endless", "Nobody", 2001, Genre::Unknown, std::numeric_limits<double>::infinity(), 2};
+
+    std::string csv;
+    details::AppendCsvRow(csv, nan, ',');
+    details::AppendCsvRow(csv, inf, ',');
+    EXPECT_EQ(csv, "Void,Nobody,2000,Unknown,,1\nEndless,Nobody,2001,Unknown,,2\n");
+    BookDatabase<std::vector<Book>> loaded;
+    EXPECT_EQ(loadBooks(loaded, csv, LoadOptions{.has_header = false}).rows_rejected, 2);
+
+    std::string json;
+    details::AppendJsonRow(json, nan);
+    details::AppendJsonRow(json, inf);
+    EXPECT_NE(json.find("\"rating\":null,\"read_count\":1}"), std::string::npos);
+    EXPECT_NE(json.find("\"rating\":null,\"read_count\":2}"), std::string::npos);
+}
+
+TEST(BookExporterTest, FailedFileExportRemovesTemporaryFile) {
+    BookDatabase<std::vector<Book>> db;
+    db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+    // Переименование поверх непустого каталога не удаётся
+    const auto dir = std::filesystem::temp_directory_path() / "bookdb_export_test_dir";
+    std::filesystem::create_directories(dir / "child");
+    EXPECT_THROW(exportBooksToFile(db, dir), std::filesystem::filesystem_error);
+    EXPECT_FALSE(std::filesystem::exists(dir.string() + ".tmp"));
+    std::filesystem::remove_all(dir);
+}
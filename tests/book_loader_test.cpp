@@ -0,0 +1,95 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "book_loader.hpp"
+
+using namespace bookdb;
+
+namespace {
+constexpr std::string_view kCsv = "title,author,year,genre,rating,read_count\n"
+                                  "1984,George Orwell,1949,SciFi,4.0,190\n"
+                                  "\"Animal Farm, a Fairy Story\",George Orwell,1945,Fiction,4.4,143\r\n"
+                                  "broken line without fields\n"
+                                  "\"The \"\"Great\"\" Gatsby\",F. Scott Fitzgerald,1925,Fiction,4.5,120\n"
+                                  "Jane Eyre,Charlotte Bronte,eighteen,Fiction,4.6,110\n"
+                                  "\n"
+                                  "The Hobbit,J.R.R. Tolkien,1937,Fantasy,4.9,203";
+}  // namespace
+
+TEST(BookLoaderTest, ParsesValidRowsAndReportsBadOnes) {
+    BookDatabase<std::vector<Book>> db;
+    const auto report = loadBooks(db, kCsv);
+
+    EXPECT_EQ(report.rows_loaded, 4);
+    EXPECT_EQ(report.rows_rejected, 2);
+    ASSERT_EQ(report.errors.size(), 2);
+    EXPECT_EQ(report.errors[0].line, 4);
+    EXPECT_EQ(report.errors[1].line, 6);
+    EXPECT_STREQ(report.errors[1].reason, "bad year");
+
+    ASSERT_EQ(db.size(), 4);
+    EXPECT_EQ(db.GetBooks()[1].title, "Animal Farm, a Fairy Story");
+    EXPECT_EQ(db.GetBooks()[2].title, "The \"Great\" Gatsby");
+    EXPECT_EQ(db.GetBooks()[3].genre, Genre::Unknown);
+    EXPECT_EQ(db.GetBooks()[3].read_count, 203);
+    EXPECT_EQ(db.GetAuthors().size(), 3);
+    EXPECT_EQ(db.GetBooks()[0].author_id, db.GetBooks()[1].author_id);
+}
+
+TEST(BookLoaderTest, RejectsNonFiniteRatings) {
+    BookDatabase<std::vector<Book>> db;
+    const auto report = loadBooks(db, "Void,Nobody,2000,Fiction,nan,1\n"
+                                      "Endless,Nobody,2000,Fiction,inf,1\n"
+                                      "Abyss,Nobody,2000,Fiction,-INFINITY,1\n"
+                                      "Solid,Nobody,2000,Fiction,4.5,1\n",
+                                  LoadOptions{.has_header = false});
+    EXPECT_EQ(report.rows_loaded, 1);
+    EXPECT_EQ(report.rows_rejected, 3);
+    ASSERT_EQ(report.errors.size(), 3);
+    EXPECT_STREQ(report.errors[0].reason, "bad rating");
+    EXPECT_EQ(db.GetBooks()[0].title, "Solid");
+}
+
+TEST(BookLoaderTest, ParallelLoadMatchesSequential) {
+    std::string tsv;
+    for (int i = 0; i < 5000; ++i) {
+        tsv += "Title " + std::to_string(i) + "\tAuthor " + std::to_string(i % 37);
+        tsv += "\t" + std::to_string(1900 + i % 100);
+        tsv += i % 10 == 0 ? "\tMystery\tnan?\t1\n" : "\tMystery\t3.5\t" + std::to_string(i) + "\n";
+    }
+
+    LoadOptions opt{.delimiter = '\t', .has_header = false, .max_errors = 1000};
+    BookDatabase<std::vector<Book>> sequential;
+    opt.par = {.threads = 1};
+    const auto seqReport = loadBooks(sequential, tsv, opt);
+
+    BookDatabase<std::vector<Book>> parallel;
+    opt.par = {.threads = 4, .min_part_size = 1024};
+    const auto parReport = loadBooks(parallel, tsv, opt);
+
+    EXPECT_EQ(seqReport.rows_loaded, 4500);
+    EXPECT_EQ(parReport.rows_loaded, seqReport.rows_loaded);
+    ASSERT_EQ(parReport.errors.size(), 500);
+    EXPECT_EQ(parReport.errors.back().line, seqReport.errors.back().line);
+    EXPECT_EQ(parReport.errors.back().line, 4991);
+    EXPECT_EQ(sequential.GetBooks(), parallel.GetBooks());
+    EXPECT_EQ(parallel.GetAuthors().size(), 37);
+}
+
+TEST(BookLoaderTest, LoadsFromFile) {
+    const auto path = std::filesystem::temp_directory_path() / "bookdb_loader_test.csv";
+    std::ofstream(path) << kCsv;
+
+    BookDatabase<std::vector<Book>> db;
+    const auto report = loadBooksFromFile(db, path);
+    std::filesystem::remove(path);
+
+    EXPECT_EQ(report.rows_loaded, 4);
+    EXPECT_GE(report.RowsPerSecond(), 0.);
+    // Строки скопированы в арену базы и переживают снятие отображения
+    EXPECT_EQ(db.GetBooks().back().title, "The Hobbit");
+    EXPECT_THROW(loadBooksFromFile(db, path), std::runtime_error);
+}
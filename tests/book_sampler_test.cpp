@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <set>
+
+#include "book_database.hpp"
+#include "book_sampler.hpp"
+#include "catalog_generator.hpp"
+#include "statsistics.hpp"
+
+using namespace bookdb;
+
+class BookSamplerTest : public ::testing::Test {
+protected:
+    BookDatabase<std::vector<Book>> db;
+
+    void SetUp() override {
+        db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 100);
+        db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 300);
+        db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 0);
+        db.EmplaceBack("Dune", "Frank Herbert", 1965, Genre::SciFi, 4.3, 600);
+    }
+};
+
+TEST_F(BookSamplerTest, WeightedDrawsFollowReadCount) {
+    BookSampler sampler(db, SampleWeight::ReadCount);
+    std::mt19937_64 gen{7};
+
+    std::array<size_t, 4> hits{};
+    for (RowId row : sampler.Sample(100000, gen))
+        ++hits[row];
+    EXPECT_EQ(hits[2], 0);
+    EXPECT_NEAR(hits[0] / 100000., 0.1, 0.01);
+    EXPECT_NEAR(hits[1] / 100000., 0.3, 0.01);
+    EXPECT_NEAR(hits[3] / 100000., 0.6, 0.01);
+
+    // Тот же seed - та же последовательность
+    std::mt19937_64 first{11}, second{11};
+    EXPECT_EQ(sampler.Sample(50, first), sampler.Sample(50, second));
+}
+
+TEST_F(BookSamplerTest, StratifiedAndDistinct) {
+    BookSampler sampler(db);
+    std::mt19937_64 gen{3};
+
+    for (int i = 0; i < 100; ++i)
+        EXPECT_EQ(db.GetBooks()[sampler.Draw(Genre::Fiction, gen)].genre, Genre::Fiction);
+    EXPECT_THROW(sampler.Draw(Genre::Mystery, gen), std::runtime_error);
+
+    std::array<size_t, kGenreCount> perGenre{};
+    for (RowId row : sampler.SampleStratified(10, gen))
+        ++perGenre[details::GenreSlot(db.GetBooks()[row].genre)];
+    EXPECT_EQ(perGenre[details::GenreSlot(Genre::Fiction)], 5);
+    EXPECT_EQ(perGenre[details::GenreSlot(Genre::SciFi)], 5);
+
+    const auto distinct = sampler.SampleDistinct(4, gen);
+    EXPECT_EQ(std::set<RowId>(distinct.begin(), distinct.end()).size(), 4);
+    EXPECT_THROW(sampler.SampleDistinct(5, gen), std::runtime_error);
+
+    BookSampler byReads(db, SampleWeight::ReadCount);
+    EXPECT_THROW(byReads.SampleDistinct(4, gen), std::runtime_error);
+    EXPECT_EQ(byReads.SampleDistinct(3, gen).size(), 3);
+}
+
+TEST(BookSamplerCatalogTest, DistinctSamplesFavourHeavyRows) {
+    BookDatabase<std::vector<Book>> db;
+    generateCatalog(db, CatalogOptions{.rows = 5000, .authors = 100});
+    BookSampler sampler(db, SampleWeight::ReadCount);
+    std::mt19937_64 gen{5};
+
+    double sampledReads = 0.;
+    for (int round = 0; round < 20; ++round)
+        for (RowId row : sampler.SampleDistinct(100, gen))
+            sampledReads += db.GetBooks()[row].read_count;
+    double totalReads = 0.;
+    for (const Book &book : db)
+        totalReads += book.read_count;
+    // Взвешенная выборка смещена к часто читаемым книгам
+    EXPECT_GT(sampledReads / 2000, totalReads / db.size());
+
+    std::mt19937_64 seeded{1};
+    EXPECT_EQ(sampleRandomBooks(db, 10, seeded).size(), 10);
+}
+
+TEST(BookSamplerCatalogTest, FenwickJournalRestoresExactly) {
+    const std::vector<double> weights{0.1, 0.7, 0.2, 1e-9, 3.3, 0.3};
+    details::FenwickTree tree(weights);
+    const double total = tree.Total();
+    details::FenwickTree::Journal journal;
+    for (size_t i : {4, 1, 5})
+        tree.Add(i, -weights[i], journal);
+    tree.Restore(journal);
+    EXPECT_EQ(tree.Total(), total);
+    EXPECT_TRUE(journal.empty());
+    const details::FenwickTree fresh(weights);
+    for (double target : {0., 0.5, 0.95, 1.0000000005, 4.2})
+        EXPECT_EQ(tree.Find(target), fresh.Find(target));
+}
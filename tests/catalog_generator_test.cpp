@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+
+#include "book_loader.hpp"
+#include "catalog_generator.hpp"
+#include "statsistics.hpp"
+
+using namespace bookdb;
+
+TEST(CatalogGeneratorTest, DeterministicForSeed) {
+    const CatalogOptions opt{.rows = 2000, .authors = 50};
+    BookDatabase<std::vector<Book>> first, second, other;
+    generateCatalog(first, opt);
+    generateCatalog(second, opt);
+    generateCatalog(other, CatalogOptions{.rows = 2000, .authors = 50, .seed = 7});
+
+    ASSERT_EQ(first.size(), 2000);
+    EXPECT_EQ(first.GetBooks(), second.GetBooks());
+    EXPECT_NE(first.GetBooks(), other.GetBooks());
+    EXPECT_LE(first.GetAuthors().size(), 50);
+}
+
+TEST(CatalogGeneratorTest, SkewFollowsOptions) {
+    CatalogOptions opt{.rows = 20000, .authors = 100, .author_skew = 1.2};
+    opt.genre_weights = {1., 0., 0., 0., 0., 0.};
+    BookDatabase<std::vector<Book>> db;
+    generateCatalog(db, opt);
+
+    const auto counts = buildAuthorHistogramDense(db);
+    const auto top = db.GetAuthors().Find("Author 0");
+    const auto tail = db.GetAuthors().Find("Author 99");
+    ASSERT_NE(top, kNoAuthorId);
+    EXPECT_GT(counts[top], 10 * (tail == kNoAuthorId ? 1 : counts[tail]));
+    EXPECT_TRUE(std::ranges::all_of(db, [](const Book &b) { return b.genre == Genre::Fiction; }));
+    EXPECT_TRUE(std::ranges::all_of(db, [](const Book &b) { return b.rating >= 0. && b.rating <= 5.; }));
+}
+
+TEST(CatalogGeneratorTest, CsvLoadsBack) {
+    const CatalogOptions opt{.rows = 500, .authors = 20};
+    BookDatabase<std::vector<Book>> generated, loaded;
+    generateCatalog(generated, opt);
+    const auto report = loadBooks(loaded, generateCatalogCsv(opt, '\t'), {.delimiter = '\t'});
+
+    EXPECT_EQ(report.rows_rejected, 0);
+    EXPECT_EQ(loaded.GetBooks(), generated.GetBooks());
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include "book_database.hpp"
+#include "columnar_book_container.hpp"
+#include "comparators.hpp"
+#include "statsistics.hpp"
+
+using namespace bookdb;
+
+static_assert(BookContainerLike<ColumnarBookContainer>);
+static_assert(ColumnarBookContainerLike<ColumnarBookContainer>);
+static_assert(!ColumnarBookContainerLike<std::vector<Book>>);
+
+class ColumnarDatabaseTest : public ::testing::Test {
+protected:
+    BookDatabase<ColumnarBookContainer> db;
+
+    void SetUp() override {
+        db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+        db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+        db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+    }
+};
+
+TEST_F(ColumnarDatabaseTest, ColumnsAndRows) {
+    const auto &books = db.GetBooks();
+
+    ASSERT_EQ(books.size(), 3);
+    EXPECT_EQ(books.GetYears()[1], 1945);
+    EXPECT_DOUBLE_EQ(books.GetRatings()[2], 4.5);
+    EXPECT_EQ(books.GetGenres()[0], Genre::SciFi);
+
+    const Book second = books[1];
+    EXPECT_EQ(second.title, "Animal Farm");
+    EXPECT_EQ(second.read_count, 143);
+    EXPECT_EQ(db.begin()->title, "1984");
+}
+
+TEST_F(ColumnarDatabaseTest, AuthorsAreInterned) {
+    const auto authors = db.GetBooks().GetAuthors();
+
+    ASSERT_EQ(db.GetAuthors().size(), 2);
+    EXPECT_EQ(authors[0].data(), authors[1].data());
+    EXPECT_EQ(authors[0], "George Orwell");
+}
+
+TEST_F(ColumnarDatabaseTest, StatisticsMatchRowStorage) {
+    BookDatabase<std::vector<Book>> rows;
+    for (const Book book : db)
+        rows.PushBack(book);
+
+    EXPECT_DOUBLE_EQ(calculateAverageRating(db), calculateAverageRating(rows));
+    EXPECT_EQ(buildAuthorHistogramFlat(db), buildAuthorHistogramFlat(rows));
+
+    auto columnar = calculateGenreRatings(db.cbegin(), db.cend());
+    auto reference = calculateGenreRatings(rows.cbegin(), rows.cend());
+    EXPECT_DOUBLE_EQ(columnar[Genre::Fiction], reference[Genre::Fiction]);
+    EXPECT_DOUBLE_EQ(columnar[Genre::SciFi], reference[Genre::SciFi]);
+}
+
+TEST_F(ColumnarDatabaseTest, SortThroughProxies) {
+    std::sort(db.begin(), db.end(), comp::GreaterByRating{});
+
+    const auto ratings = db.GetBooks().GetRatings();
+    EXPECT_TRUE(std::is_sorted(ratings.begin(), ratings.end(), std::greater<>{}));
+    EXPECT_EQ(db.begin()->title, "The Great Gatsby");
+    EXPECT_EQ(db.back().title, "1984");
+    EXPECT_EQ(db.back().author, "George Orwell");
+}
@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catalog_generator.hpp"
+#include "concurrent_book_database.hpp"
+#include "filters.hpp"
+
+using namespace bookdb;
+
+TEST(ConcurrentBookDatabaseTest, MatchesSequentialDatabase) {
+    const CatalogOptions opt{.rows = 20000, .authors = 300};
+    BookDatabase<std::vector<Book>> reference;
+    generateCatalog(reference, opt);
+
+    ConcurrentBookDatabase db(4);
+    std::vector<std::thread> writers;
+    for (size_t w = 0; w < 4; ++w)
+        writers.emplace_back([&, w] {
+            const auto books = std::span(reference.GetBooks()).subspan(w * 5000, 5000);
+            for (size_t i = 0; i < books.size(); i += 100)
+                db.Append(books.subspan(i, std::min<size_t>(100, books.size() - i)));
+        });
+    for (auto &writer : writers)
+        writer.join();
+
+    const auto view = db.GetView();
+    ASSERT_EQ(view.size(), reference.size());
+    EXPECT_EQ(view.GetAuthorCount(), reference.GetAuthors().size());
+    EXPECT_NEAR(calculateAverageRating(view), calculateAverageRating(reference), 1e-9);
+    EXPECT_EQ(calculateGenreRatings(view).size(), kGenreCount);
+
+    const auto query = all_of(YearBetween(1900, 1950), RatingAbove(4.));
+    EXPECT_EQ(filterBooks(view, query).size(), filterBooks(reference.cbegin(), reference.cend(), query).size());
+
+    const auto dense = buildAuthorHistogramDense(view);
+    const AuthorId top = db.GetAuthors().Find("Author 0");
+    ASSERT_NE(top, kNoAuthorId);
+    EXPECT_EQ(dense[top], buildAuthorHistogramDense(reference)[reference.GetAuthors().Find("Author 0")]);
+    view.ForEach([&](const Book &book) { EXPECT_EQ(db.GetAuthors().GetName(book.author_id), book.author); });
+}
+
+TEST(ConcurrentBookDatabaseTest, ReadersSeeGrowingPrefixes) {
+    ConcurrentBookDatabase db(2);
+    std::atomic<bool> done{false};
+    std::thread writer([&] {
+        for (int i = 0; i < 20000; ++i)
+            db.EmplaceBack("Title " + std::to_string(i), "Author " + std::to_string(i % 50), 2000, Genre::Mystery,
+                           4., i);
+        done = true;
+    });
+
+    size_t last = 0;
+    while (!done) {
+        const auto view = db.GetView();
+        EXPECT_GE(view.size(), last);
+        last = view.size();
+        size_t seen = 0;
+        view.ForEach([&](const Book &book) {
+            ++seen;
+            EXPECT_EQ(book.title.substr(0, 6), "Title ");
+            EXPECT_LT(book.author_id, view.GetAuthorCount());
+        });
+        EXPECT_EQ(seen, view.size());
+    }
+    writer.join();
+    EXPECT_EQ(db.GetView().size(), 20000);
+}
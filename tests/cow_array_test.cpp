@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <thread>
+
+#include "bitmap_filter.hpp"
+#include "book_database.hpp"
+#include "catalog_generator.hpp"
+#include "cow_array.hpp"
+#include "statsistics.hpp"
+
+using namespace bookdb;
+
+TEST(CowArrayTest, CopySharesChunksUntilWrite) {
+    CowArray<int, 4> arr;
+    for (int i = 0; i < 10; ++i)
+        arr.push_back(i);
+    EXPECT_EQ(arr.GetSharedChunkCount(), 0);
+
+    CowArray<int, 4> copy = arr;
+    EXPECT_EQ(copy.GetSharedChunkCount(), 3);
+    copy[5] = 50;
+    EXPECT_EQ(copy.GetSharedChunkCount(), 2);
+    EXPECT_EQ(arr[5], 5);
+    EXPECT_EQ(copy[5], 50);
+
+    copy.push_back(10);
+    copy.resize(3);
+    EXPECT_EQ(arr.size(), 10);
+    EXPECT_EQ(arr.back(), 9);
+    EXPECT_EQ(copy.size(), 3);
+    EXPECT_EQ(copy.back(), 2);
+    EXPECT_TRUE(std::ranges::equal(copy, std::vector<int>{0, 1, 2}));
+    EXPECT_EQ(*(arr.end() - 2), 8);
+}
+
+TEST(CowSnapshotTest, IsolatedFromWriter) {
+    auto db = std::make_unique<BookDatabase<CowBookContainer>>();
+    generateCatalog(*db, CatalogOptions{.rows = 20000, .authors = 500});
+    db->EnableAggregates();
+    db->EnableIndexes();
+
+    const auto snapshot = db->TakeSnapshot();
+    const auto &books = snapshot->GetBooks();
+    EXPECT_EQ(books.GetSharedChunkCount(), books.size() / CowBookContainer::kChunkSize + 1);
+    EXPECT_EQ(snapshot->GetIndexes(), nullptr);
+    const size_t fiction = countBooks(*snapshot, GenreIs(Genre::Fiction));
+    const double rating = calculateAverageRating(*snapshot);
+    const std::string title(snapshot->GetBooks()[7].title);
+
+    db->Erase(7);
+    db->Update(8, BookUpdate{.rating = 0.});
+    db->EmplaceBack("Fresh", "Brand New Author", 2025, Genre::Fiction, 5.0, 1);
+    EXPECT_EQ(db->size(), 20001);
+    EXPECT_EQ(db->GetAuthors().Find("Brand New Author"), 500);
+
+    EXPECT_EQ(snapshot->size(), 20000);
+    EXPECT_FALSE(snapshot->IsErased(7));
+    EXPECT_EQ(snapshot->GetAuthors().size(), 500);
+    EXPECT_EQ(snapshot->GetAuthors().Find("Brand New Author"), kNoAuthorId);
+    EXPECT_EQ(countBooks(*snapshot, GenreIs(Genre::Fiction)), fiction);
+    EXPECT_NEAR(calculateAverageRating(*snapshot), rating, 1e-9);
+
+    // Строки снимка живут дольше базы
+    db.reset();
+    EXPECT_EQ(snapshot->GetBooks()[7].title, title);
+    EXPECT_EQ(snapshot->GetAuthors().GetName(snapshot->GetBooks()[7].author_id), snapshot->GetBooks()[7].author);
+}
+
+TEST(CowSnapshotTest, ReaderRunsWhileWriterIngests) {
+    BookDatabase<CowBookContainer> db;
+    generateCatalog(db, CatalogOptions{.rows = 10000, .authors = 100});
+    const auto snapshot = db.TakeSnapshot();
+    const size_t expected = countBooks(*snapshot, YearBetween(1900, 2000));
+
+    std::thread reader([&] {
+        for (int i = 0; i < 20; ++i)
+            EXPECT_EQ(countBooks(*snapshot, YearBetween(1900, 2000)), expected);
+    });
+    for (int i = 0; i < 10000; ++i) {
+        db.EmplaceBack("Title", "Writer " + std::to_string(i % 300), 1950, Genre::SciFi, 4.0, i);
+        if (i % 10 == 0)
+            db.Update(i, BookUpdate{.year = 1950});
+    }
+    reader.join();
+    EXPECT_EQ(snapshot->size(), 10000);
+    EXPECT_GT(countBooks(db, YearBetween(1900, 2000)), expected);
+}
@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
 #include "book_database.hpp"
 #include "comparators.hpp"
 #include "filters.hpp"
@@ -76,6 +80,26 @@ TEST_F(BookDatabaseTest, InvalidInputHandling) {
     EXPECT_DOUBLE_EQ(db.GetBooks().back().rating, -1.0);
 }
 
+TEST_F(BookDatabaseTest, NonFiniteRatingRejected) {
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double inf = std::numeric_limits<double>::infinity();
+    db.EnableIndexes();
+    db.EnableOrderIndex<comp::GreaterByRating>();
+
+    EXPECT_THROW(db.EmplaceBack("NaN", "Author", 2023, Genre::Mystery, nan, 5), std::invalid_argument);
+    EXPECT_THROW(db.PushBack(Book{"Inf", "Author", 2023, Genre::Mystery, inf, 5}), std::invalid_argument);
+    const std::vector<Book> batch{{"Fine", "New Author", 2023, Genre::Mystery, 3., 5},
+                                  {"Inf", "New Author", 2023, Genre::Mystery, -inf, 5}};
+    EXPECT_THROW(db.BulkInsert(batch), std::invalid_argument);
+    EXPECT_EQ(db.size(), 3);
+    EXPECT_EQ(db.GetAuthors().size(), 2);
+
+    EXPECT_THROW(db.Update(0, BookUpdate{.year = 2000, .rating = nan}), std::invalid_argument);
+    EXPECT_EQ(db.GetBooks()[0].year, 1949);
+    EXPECT_EQ(db.GetBooks()[0].rating, 4.0);
+    EXPECT_EQ(db.GetOrderIndex<comp::GreaterByRating>()->Rows(), (std::vector<RowId>{2, 1, 0}));
+}
+
 TEST_F(BookDatabaseTest, AuthorHistogramCalculation) {
     auto histogram = buildAuthorHistogramFlat(db);
 
@@ -134,6 +158,35 @@ TEST_F(BookDatabaseTest, CompositeFilterApplication) {
     EXPECT_EQ(filtered[1].get().title, "The Great Gatsby");
 }
 
+TEST_F(BookDatabaseTest, LazyFilterView) {
+    auto fiction = filterView(db.cbegin(), db.cend(), GenreIs(Genre::Fiction));
+
+    auto it = fiction.begin();
+    ASSERT_NE(it, fiction.end());
+    EXPECT_EQ(it->title, "Animal Farm");
+    EXPECT_EQ(std::ranges::distance(fiction), 2);
+    EXPECT_TRUE(std::ranges::empty(filterView(db.cbegin(), db.cend(), YearBetween(2000, 2020))));
+}
+
+TEST_F(BookDatabaseTest, ChunkedAndCountOnlyFilter) {
+    std::vector<size_t> chunks;
+    std::vector<std::string_view> titles;
+    const size_t selected = forEachFilteredChunk(db.cbegin(), db.cend(), RatingAbove(3.), 2, [&](auto chunk) {
+        chunks.push_back(chunk.size());
+        for (const Book &book : chunk)
+            titles.push_back(book.title);
+    });
+    EXPECT_EQ(selected, 3);
+    EXPECT_EQ(chunks, (std::vector<size_t>{2, 1}));
+    EXPECT_EQ(titles, (std::vector<std::string_view>{"1984", "Animal Farm", "The Great Gatsby"}));
+
+    // Обход останавливается, как только обработчик вернул false
+    EXPECT_EQ(forEachFilteredChunk(db.cbegin(), db.cend(), RatingAbove(3.), 1, [](auto) { return false; }), 1);
+
+    EXPECT_EQ(countBooks(db.cbegin(), db.cend(), YearBetween(1940, 1950)), 2);
+    EXPECT_EQ(countBooks(db.cbegin(), db.cend(), AuthorIs("Nobody")), 0);
+}
+
 TEST_F(BookDatabaseTest, PredicateFactories) {
     // Тест фабрики RatingAbove
     auto highRated = filterBooks(db.cbegin(), db.cend(), RatingAbove(4.4));
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <format>
+#include <thread>
+
+#include "book_database.hpp"
+#include "comparators.hpp"
+#include "metrics.hpp"
+#include "query_planner.hpp"
+#include "statsistics.hpp"
+#include "top_k.hpp"
+
+using namespace bookdb;
+using metrics::Counter;
+using metrics::Operation;
+
+TEST(MetricsTest, LatencyHistogramQuantiles) {
+    metrics::LatencyHistogram histogram;
+    for (uint64_t ns : {0, 3, 100, 120, 5000})
+        histogram.Record(ns);
+
+    EXPECT_EQ(histogram.GetCount(), 5);
+    EXPECT_EQ(histogram.GetTotalNs(), 5223);
+    EXPECT_EQ(histogram.GetQuantileNs(0.), 1);
+    EXPECT_EQ(histogram.GetQuantileNs(0.5), 128);
+    EXPECT_EQ(histogram.GetQuantileNs(1.), 8192);
+}
+
+TEST(MetricsTest, CountsOperationsAcrossThreads) {
+    if constexpr (!metrics::kEnabled)
+        GTEST_SKIP() << "built without BOOKDB_ENABLE_METRICS";
+
+    metrics::Reset();
+    BookDatabase<std::vector<Book>> db;
+    db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+    db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+    std::thread([&db] {
+        EXPECT_EQ(filterBookIds(db, all_of(YearBetween(1946, 1999), RatingAbove(3.))).size(), 1);
+    }).join();
+    getTopKBy(db, 1, comp::GreaterByRating{});
+    calculateAverageRating(db);
+
+    const auto snapshot = metrics::Collect();
+    EXPECT_EQ(snapshot.Get(Counter::Inserts), 2);
+    EXPECT_EQ(snapshot.Get(Counter::AuthorInternMisses), 1);
+    EXPECT_EQ(snapshot.Get(Counter::AuthorInternHits), 1);
+    EXPECT_EQ(snapshot.Get(Counter::FilterCalls), 1);
+    EXPECT_EQ(snapshot.Get(Counter::RowsScanned), 2);
+    EXPECT_EQ(snapshot.Get(Counter::RowsSelected), 1);
+    EXPECT_EQ(snapshot.Get(Counter::TopKCalls), 1);
+    EXPECT_EQ(snapshot.Get(Counter::StatsCalls), 1);
+    EXPECT_EQ(snapshot.GetLatency(Operation::Insert).GetCount(), 2);
+
+    const std::string text = std::format("{}", snapshot);
+    EXPECT_NE(text.find("bookdb_inserts_total 2\n"), std::string::npos);
+    EXPECT_NE(text.find("bookdb_latency_ns_count{op=\"filter\"} 1\n"), std::string::npos);
+
+    metrics::Reset();
+    EXPECT_EQ(metrics::Collect().Get(Counter::Inserts), 0);
+}
+
+TEST(MetricsTest, ResetDuringWritesIsNotUndone) {
+    if constexpr (!metrics::kEnabled)
+        GTEST_SKIP() << "built without BOOKDB_ENABLE_METRICS";
+
+    std::atomic<uint64_t> inserted{0};
+    std::atomic<bool> stop{false};
+    std::thread writer([&] {
+        BookDatabase<std::vector<Book>> db;
+        while (!stop.load()) {
+            db.EmplaceBack("Title", "Author", 2000, Genre::Fiction, 4.0, 1);
+            inserted.fetch_add(1);
+        }
+    });
+    // После сброса видны только вставки, начатые после него
+    for (int round = 0; round < 1000; ++round) {
+        const uint64_t before = inserted.load();
+        metrics::Reset();
+        const uint64_t seen = metrics::Collect().Get(Counter::Inserts);
+        EXPECT_LE(seen, inserted.load() - before + 1);
+    }
+    stop = true;
+    writer.join();
+}
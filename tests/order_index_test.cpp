@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+
+#include "book_database.hpp"
+#include "catalog_generator.hpp"
+#include "columnar_book_container.hpp"
+#include "comparators.hpp"
+#include "order_index.hpp"
+
+using namespace bookdb;
+
+class OrderIndexTest : public ::testing::Test {
+protected:
+    BookDatabase<std::vector<Book>> db;
+
+    void SetUp() override {
+        db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+        db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+        db.EnableOrderIndex<comp::GreaterByRating>();
+        db.EnableOrderIndex<comp::LessByAuthor>();
+        db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+        db.EmplaceBack("Pride and Prejudice", "Jane Austen", 1813, Genre::Fiction, 4.0, 178);
+    }
+};
+
+TEST_F(OrderIndexTest, OrderedIterationWithoutSorting) {
+    const auto *byRating = db.GetOrderIndex<comp::GreaterByRating>();
+    ASSERT_NE(byRating, nullptr);
+    EXPECT_EQ(db.GetOrderIndex<comp::LessByPopularity>(), nullptr);
+
+    // Равные рейтинги идут в порядке вставки
+    EXPECT_EQ(byRating->Rows(), (std::vector<RowId>{2, 1, 0, 3}));
+    EXPECT_EQ(byRating->First(2), (std::vector<RowId>{2, 1}));
+    EXPECT_EQ(byRating->Between(4.4, 4.0), (std::vector<RowId>{1, 0, 3}));
+    EXPECT_EQ(db.GetOrderIndex<comp::LessByAuthor>()->Rows(), (std::vector<RowId>{2, 0, 1, 3}));
+    EXPECT_EQ(db.GetOrderIndex<comp::LessByAuthor>()->Between("G", "H"), (std::vector<RowId>{0, 1}));
+    // Сами книги остались на месте
+    EXPECT_EQ(db.GetBooks()[0].title, "1984");
+
+    db.Clear();
+    EXPECT_EQ(byRating->size(), 0);
+}
+
+TEST_F(OrderIndexTest, FallbackMatchesIndex) {
+    const auto indexed = orderedBookIds(db, comp::GreaterByRating{});
+    db.DisableOrderIndex<comp::GreaterByRating>();
+    EXPECT_EQ(orderedBookIds(db, comp::GreaterByRating{}), indexed);
+    EXPECT_EQ(orderedBookIds(db, comp::GreaterByRating{}, 3), (std::vector<RowId>{2, 1, 0}));
+}
+
+TEST_F(OrderIndexTest, ErasedRowsLeaveIndex) {
+    db.Erase(1);
+    const auto *byRating = db.GetOrderIndex<comp::GreaterByRating>();
+    EXPECT_EQ(byRating->size(), 3);
+    EXPECT_EQ(byRating->Rows(), (std::vector<RowId>{2, 0, 3}));
+    EXPECT_EQ(byRating->Between(4.4, 4.0), (std::vector<RowId>{0, 3}));
+
+    // Индекс, включённый после удаления, строится без удалённых строк
+    db.EnableOrderIndex<comp::LessByPopularity>();
+    EXPECT_EQ(db.GetOrderIndex<comp::LessByPopularity>()->Rows(), (std::vector<RowId>{2, 3, 0}));
+}
+
+TEST(OrderIndexCatalogTest, DeltaMergesMatchStableSort) {
+    BookDatabase<ColumnarBookContainer> db;
+    db.EnableOrderIndex<comp::LessByPopularity>();
+    db.EnableOrderIndex<comp::LessByAuthor>();
+    generateCatalog(db, CatalogOptions{.rows = 5000, .authors = 100});
+
+    BookDatabase<ColumnarBookContainer> plain;
+    generateCatalog(plain, CatalogOptions{.rows = 5000, .authors = 100});
+    EXPECT_EQ(orderedBookIds(db, comp::LessByPopularity{}), orderedBookIds(plain, comp::LessByPopularity{}));
+    EXPECT_EQ(orderedBookIds(db, comp::LessByAuthor{}, 100), orderedBookIds(plain, comp::LessByAuthor{}, 100));
+}
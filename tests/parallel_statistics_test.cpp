@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+
+#include "book_database.hpp"
+#include "columnar_book_container.hpp"
+#include "parallel_statistics.hpp"
+#include "statsistics.hpp"
+#include "thread_pool.hpp"
+
+using namespace bookdb;
+
+class ParallelStatisticsTest : public ::testing::Test {
+protected:
+    static constexpr size_t kRows = 50'000;
+
+    ThreadPool pool{4};
+    Parallelism par{.threads = 8, .pool = &pool, .min_part_size = 1024};
+    BookDatabase<std::vector<Book>> db;
+
+    void SetUp() override {
+        std::mt19937 gen{3};
+        std::uniform_int_distribution<int> author(0, 499);
+        std::uniform_int_distribution<int> genre(0, static_cast<int>(Genre::Unknown));
+        std::uniform_real_distribution<double> rating(0., 5.);
+        for (size_t i = 0; i < kRows; ++i) {
+            const std::string name = "Author " + std::to_string(author(gen));
+            db.EmplaceBack("Title", name, 2000, static_cast<Genre>(genre(gen)), rating(gen), 1);
+        }
+    }
+};
+
+TEST_F(ParallelStatisticsTest, HistogramMatchesSerial) {
+    EXPECT_EQ(buildAuthorHistogramFlatParallel(db, par), buildAuthorHistogramFlat(db));
+}
+
+TEST_F(ParallelStatisticsTest, RatingsMatchSerial) {
+    auto serial = calculateGenreRatings(db.cbegin(), db.cend());
+    auto parallel = calculateGenreRatingsParallel(db.cbegin(), db.cend(), par);
+    for (size_t i = 0; i < kGenreCount; ++i)
+        EXPECT_NEAR(parallel[static_cast<Genre>(i)], serial[static_cast<Genre>(i)], 1e-12);
+
+    EXPECT_NEAR(calculateAverageRatingParallel(db, par), calculateAverageRating(db), 1e-12);
+
+    BookDatabase<ColumnarBookContainer> columns;
+    for (const auto &book : db)
+        columns.PushBack(book);
+    EXPECT_NEAR(calculateAverageRatingParallel(columns, par), calculateAverageRating(db), 1e-12);
+}
+
+TEST(ParallelForTest, CoversRangeAndPropagatesErrors) {
+    ThreadPool pool{3};
+    const Parallelism par{.threads = 5, .pool = &pool, .min_part_size = 1};
+
+    std::vector<std::atomic<int>> hits(100);
+    ParallelFor(hits.size(), par, [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            ++hits[i];
+    });
+    for (const auto &hit : hits)
+        EXPECT_EQ(hit.load(), 1);
+
+    EXPECT_THROW(ParallelFor(hits.size(), par,
+                             [](size_t part, size_t, size_t) {
+                                 if (part == 3)
+                                     throw std::runtime_error{"part failed"};
+                             }),
+                 std::runtime_error);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "book_database.hpp"
+#include "columnar_book_container.hpp"
+#include "filters.hpp"
+#include "query_planner.hpp"
+
+using namespace bookdb;
+
+class QueryPlannerTest : public ::testing::Test {
+protected:
+    BookDatabase<ColumnarBookContainer> db;
+
+    void SetUp() override {
+        std::mt19937 gen{1};
+        std::uniform_int_distribution<int> year(1800, 2020);
+        std::uniform_int_distribution<int> genre(0, static_cast<int>(Genre::Unknown));
+        std::uniform_real_distribution<double> rating(0., 5.);
+        const std::array<std::string_view, 4> authors{"Common A", "Common B", "Common C", "Rare"};
+        for (int i = 0; i < 4000; ++i) {
+            const auto author = i % 100 == 0 ? authors[3] : authors[i % 3];
+            db.EmplaceBack("Title", author, year(gen), static_cast<Genre>(genre(gen)), rating(gen), i);
+        }
+    }
+
+    template <typename P>
+    std::vector<RowId> Expected(const P &iPred) const {
+        std::vector<RowId> res;
+        RowId row = 0;
+        for (const auto &book : db) {
+            if (iPred(book))
+                res.push_back(row);
+            ++row;
+        }
+        return res;
+    }
+};
+
+TEST_F(QueryPlannerTest, CheapSelectivePredicatesFirst) {
+    auto opaque = [](const Book &b) { return b.read_count % 2 == 0; };
+    auto plan = planQuery(db, all_of(opaque, RatingAbove(1.), GenreIs(Genre::SciFi)));
+
+    // Жанр самый селективный, лямбда - самая дорогая
+    EXPECT_EQ(plan.GetRoot().GetOrder(), (std::array<size_t, 3>{2, 1, 0}));
+    EXPECT_EQ(plan.GetAccessPath(), AccessPath::FullScan);
+}
+
+TEST_F(QueryPlannerTest, IndexChosenOnlyForSelectiveConjunct) {
+    db.EnableIndexes();
+
+    auto rare = planQuery(db, all_of(YearBetween(1800, 2020), AuthorIs("Rare")));
+    EXPECT_EQ(rare.GetAccessPath(), AccessPath::Index);
+    EXPECT_EQ(rare.GetRoot().GetOrder()[0], 1);
+
+    auto wide = planQuery(db, all_of(YearBetween(1800, 2020), AuthorIs("Common A")));
+    EXPECT_EQ(wide.GetAccessPath(), AccessPath::FullScan);
+}
+
+TEST_F(QueryPlannerTest, ResultsMatchScanForEveryAccessPath) {
+    auto opaque = [](const Book &b) { return b.read_count % 3 != 0; };
+    auto filter = all_of(any_of(GenreIs(Genre::Fiction), RatingAbove(4.5)), AuthorIs("Rare"), opaque,
+                         YearBetween(1850, 1990));
+    const auto expected = Expected(filter);
+
+    EXPECT_EQ(filterBookIds(db, filter), expected);
+    db.EnableIndexes();
+    EXPECT_EQ(planQuery(db, filter).GetAccessPath(), AccessPath::Index);
+    EXPECT_EQ(filterBookIds(db, filter), expected);
+
+    auto disjunction = any_of(AuthorIs("Rare"), YearBetween(1900, 1901));
+    EXPECT_EQ(filterBookIds(db, disjunction), Expected(disjunction));
+}
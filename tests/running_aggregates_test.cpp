@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "book_database.hpp"
+#include "running_aggregates.hpp"
+#include "statsistics.hpp"
+
+using namespace bookdb;
+
+class RunningAggregatesTest : public ::testing::Test {
+protected:
+    BookDatabase<std::vector<Book>> db;
+
+    void SetUp() override {
+        db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+        db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+        db.EnableAggregates();
+        db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+    }
+};
+
+TEST_F(RunningAggregatesTest, MaintainedOnInsert) {
+    const auto *aggregates = db.GetAggregates();
+    ASSERT_NE(aggregates, nullptr);
+
+    EXPECT_EQ(aggregates->GetBookCount(), 3);
+    EXPECT_DOUBLE_EQ(aggregates->GetAverageRating(), (4.0 + 4.4 + 4.5) / 3);
+    EXPECT_DOUBLE_EQ(aggregates->GetGenreRating(Genre::Fiction), (4.4 + 4.5) / 2);
+    EXPECT_DOUBLE_EQ(aggregates->GetGenreRating(Genre::Mystery), 0.);
+    EXPECT_EQ(aggregates->GetAuthorCount(db.GetAuthors().Find("George Orwell")), 2);
+    EXPECT_EQ(aggregates->GetTotalReadCount(), 190 + 143 + 120);
+}
+
+TEST_F(RunningAggregatesTest, StatisticsUseAggregates) {
+    auto histogram = buildAuthorHistogramFlat(db);
+    EXPECT_EQ(histogram["George Orwell"], 2);
+    EXPECT_EQ(histogram["F. Scott Fitzgerald"], 1);
+
+    db.DisableAggregates();
+    const double scanned = calculateAverageRating(db);
+    db.EnableAggregates();
+    EXPECT_DOUBLE_EQ(calculateAverageRating(db), scanned);
+}
+
+TEST_F(RunningAggregatesTest, ResetOnClear) {
+    db.Clear();
+    EXPECT_EQ(db.GetAggregates()->GetBookCount(), 0);
+    EXPECT_EQ(db.GetAggregates()->GetAuthorCount(db.GetAuthors().Find("George Orwell")), 0);
+    EXPECT_DOUBLE_EQ(calculateAverageRating(db), 0.);
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "book_database.hpp"
+#include "filters.hpp"
+#include "query_planner.hpp"
+#include "secondary_index.hpp"
+
+using namespace bookdb;
+
+class SecondaryIndexTest : public ::testing::Test {
+protected:
+    BookDatabase<std::vector<Book>> db;
+
+    void SetUp() override {
+        db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+        db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+        db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+        db.EnableIndexes();
+    }
+};
+
+TEST_F(SecondaryIndexTest, PostingLists) {
+    const auto *indexes = db.GetIndexes();
+    ASSERT_NE(indexes, nullptr);
+
+    EXPECT_EQ(indexes->ByAuthor("George Orwell"), (std::vector<RowId>{0, 1}));
+    EXPECT_EQ(indexes->ByGenre(Genre::Fiction), (std::vector<RowId>{1, 2}));
+    EXPECT_TRUE(indexes->ByAuthor("Nobody").empty());
+    EXPECT_EQ(indexes->ByYear().Between(1940, 1950), (std::vector<RowId>{0, 1}));
+    EXPECT_EQ(indexes->ByRating().Above(4.0), (std::vector<RowId>{1, 2}));
+}
+
+TEST_F(SecondaryIndexTest, IndexedFilterBooks) {
+    auto orwell = filterBooks(db, AuthorIs("George Orwell"));
+    ASSERT_EQ(orwell.size(), 2);
+    EXPECT_EQ(orwell[0].get().title, "1984");
+
+    // Непроиндексированный конъюнкт проверяется по строкам-кандидатам
+    auto filtered =
+        filterBooks(db, all_of(GenreIs(Genre::Fiction), [](const Book &b) { return b.title.starts_with("The"); }));
+    ASSERT_EQ(filtered.size(), 1);
+    EXPECT_EQ(filtered[0].get().title, "The Great Gatsby");
+}
+
+TEST_F(SecondaryIndexTest, ConsistentThroughInsertAndClear) {
+    db.PushBack(Book{"Homage to Catalonia", "George Orwell", 1938, Genre::NonFiction, 4.1, 80});
+    EXPECT_EQ(db.GetIndexes()->ByAuthor("George Orwell"), (std::vector<RowId>{0, 1, 3}));
+
+    db.Clear();
+    EXPECT_TRUE(db.GetIndexes()->ByAuthor("George Orwell").empty());
+    EXPECT_EQ(db.GetIndexes()->ByYear().size(), 0);
+
+    db.EmplaceBack("Emma", "Jane Austen", 1815, Genre::Fiction, 4.0, 50);
+    EXPECT_EQ(filterBookIds(db, AuthorIs("Jane Austen")), (std::vector<RowId>{0}));
+}
+
+TEST(SecondaryIndexRandomTest, MatchesFullScan) {
+    BookDatabase<std::vector<Book>> indexed;
+    BookDatabase<std::vector<Book>> plain;
+    indexed.EnableIndexes();
+
+    // Строк больше порога слияния дельты упорядоченного индекса
+    std::mt19937 gen{7};
+    std::uniform_int_distribution<int> year(1800, 2020);
+    std::uniform_int_distribution<int> genre(0, static_cast<int>(Genre::Unknown));
+    std::uniform_real_distribution<double> rating(0., 5.);
+    const std::array<std::string_view, 3> authors{"A", "B", "C"};
+    for (int i = 0; i < 5000; ++i) {
+        Book book{"T", authors[i % 3], year(gen), static_cast<Genre>(genre(gen)), rating(gen), i};
+        indexed.PushBack(book);
+        plain.PushBack(book);
+    }
+
+    auto filter =
+        any_of(all_of(YearBetween(1900, 1950), RatingAbove(3.)), all_of(AuthorIs("B"), GenreIs(Genre::SciFi)));
+    EXPECT_EQ(filterBookIds(indexed, filter), filterBookIds(plain, filter));
+    EXPECT_EQ(filterBookIds(indexed, YearBetween(1990, 1995)), filterBookIds(plain, YearBetween(1990, 1995)));
+}
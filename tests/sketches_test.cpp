@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <string>
+
+#include "book_database.hpp"
+#include "catalog_generator.hpp"
+#include "sketches.hpp"
+
+using namespace bookdb;
+
+TEST(SketchesTest, HyperLogLogMergesShards) {
+    HyperLogLog first, second;
+    for (int i = 0; i < 60000; ++i)
+        (i % 2 ? first : second).Add(i % 50000);
+
+    EXPECT_NEAR(first.Estimate(), 25000, 25000 * 0.03);
+    first.Merge(second);
+    EXPECT_NEAR(first.Estimate(), 50000, 50000 * 0.03);
+    EXPECT_THROW(first.Merge(HyperLogLog(10)), std::runtime_error);
+
+    HyperLogLog small;
+    for (int i = 0; i < 10; ++i)
+        small.Add(std::to_string(i % 5));
+    EXPECT_NEAR(small.Estimate(), 5, 0.1);
+}
+
+TEST(SketchesTest, KllQuantilesWithinRankError) {
+    KllSketch first, second;
+    for (int i = 0; i < 100000; ++i)
+        (i % 3 ? first : second).Add((i * 7919) % 100000);
+    first.Merge(second);
+
+    ASSERT_EQ(first.GetCount(), 100000);
+    EXPECT_EQ(first.GetQuantile(0.), 0);
+    EXPECT_EQ(first.GetQuantile(1.), 99999);
+    for (double q : {0.1, 0.5, 0.9, 0.99})
+        EXPECT_NEAR(first.GetQuantile(q), q * 100000, 100000 * 0.02) << q;
+    EXPECT_NEAR(first.GetRank(25000), 0.25, 0.02);
+}
+
+TEST(SketchesTest, SpaceSavingFindsHeavyHitters) {
+    SpaceSaving<int> first(16), second(16);
+    for (int i = 0; i < 10000; ++i) {
+        auto &sketch = i % 2 ? first : second;
+        sketch.Add(i % 100 < 30 ? 1 : 100 + i % 997);
+        sketch.Add(2, i % 10 == 0 ? 5 : 0);
+    }
+    first.Merge(second);
+
+    const auto top = first.Top(2);
+    ASSERT_EQ(top.size(), 2);
+    // Ключ 2 набрал вес 5000 за 1000 добавлений, ключ 1 - 3000 единичных
+    EXPECT_EQ(top[0].key, 2);
+    EXPECT_GE(top[0].count, 5000);
+    EXPECT_LE(top[0].count - top[0].error, 5000);
+    EXPECT_EQ(top[1].key, 1);
+    EXPECT_GE(top[1].count, 3000);
+    EXPECT_LE(top[1].count - top[1].error, 3000);
+    EXPECT_EQ(first.GetTotal(), 10000 + 5000);
+}
+
+TEST(SketchesTest, DatabaseMaintainsCatalogSketches) {
+    BookDatabase<std::vector<Book>> db;
+    generateCatalog(db, CatalogOptions{.rows = 20000, .authors = 300});
+    db.EnableSketches();
+    db.EmplaceBack("Bestseller", "Famous Author", 2030, Genre::Fiction, 5.0, 1'000'000'000);
+
+    const auto *sketches = db.GetSketches();
+    ASSERT_NE(sketches, nullptr);
+    EXPECT_NEAR(sketches->GetDistinctAuthors(), db.GetAuthors().size(), db.GetAuthors().size() * 0.05);
+
+    std::vector<double> ratings;
+    for (const Book &book : db)
+        ratings.push_back(book.rating);
+    std::ranges::sort(ratings);
+    EXPECT_NEAR(sketches->GetRatingQuantile(0.5), ratings[ratings.size() / 2], 0.1);
+    EXPECT_EQ(sketches->GetYearQuantile(1.), 2030);
+    EXPECT_EQ(sketches->GetTopAuthors(1).front().key, "Famous Author");
+    EXPECT_EQ(sketches->GetTopTitles(1).front().key, "Bestseller");
+
+    db.Clear();
+    EXPECT_EQ(sketches->GetRatings().GetCount(), 0);
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+
+#include "columnar_book_container.hpp"
+#include "snapshot.hpp"
+
+using namespace bookdb;
+
+class SnapshotTest : public ::testing::Test {
+protected:
+    BookDatabase<std::vector<Book>> db;
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "bookdb_snapshot_test.bin";
+
+    void SetUp() override {
+        db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+        db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+        db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+        db.EmplaceBack("", "", 2000, Genre::Unknown, 0., 0);
+        saveSnapshot(db, path);
+    }
+    void TearDown() override { std::filesystem::remove(path); }
+
+    void Corrupt(size_t iOffset, char iByte) {
+        std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(iOffset));
+        file.put(iByte);
+    }
+};
+
+TEST_F(SnapshotTest, ReadsInPlace) {
+    const Snapshot snapshot(path);
+    ASSERT_EQ(snapshot.size(), db.size());
+    EXPECT_EQ(snapshot.GetAuthorCount(), 3);
+    EXPECT_EQ(snapshot.GetTitle(1), "The Great Gatsby");
+    EXPECT_EQ(snapshot.GetRatings()[2], 4.4);
+    EXPECT_EQ(snapshot[2].author, "George Orwell");
+    EXPECT_EQ(snapshot[2].author_id, snapshot[0].author_id);
+
+    size_t row = 0;
+    for (const Book &book : snapshot.Rows())
+        EXPECT_EQ(book, db.GetBooks()[row++]);
+}
+
+TEST_F(SnapshotTest, LoadsIntoDatabase) {
+    BookDatabase<ColumnarBookContainer> restored;
+    restored.EmplaceBack("Brave New World", "Aldous Huxley", 1932, Genre::SciFi, 4.5, 98);
+    loadSnapshot(restored, path);
+
+    ASSERT_EQ(restored.size(), db.size() + 1);
+    EXPECT_EQ(restored.GetAuthors().size(), 4);
+    EXPECT_EQ(Book(restored.GetBooks()[3]), db.GetBooks()[2]);
+    EXPECT_EQ(restored.GetBooks()[3].author_id, restored.GetAuthors().Find("George Orwell"));
+}
+
+TEST_F(SnapshotTest, RejectsDamagedFiles) {
+    Corrupt(0, 'X');
+    EXPECT_THROW(Snapshot{path}, std::runtime_error);
+
+    saveSnapshot(db, path);
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 8);
+    EXPECT_THROW(Snapshot{path}, std::runtime_error);
+
+    // Номер автора первой строки за пределами словаря ловит только полная проверка
+    saveSnapshot(db, path);
+    const Snapshot valid(path);
+    const auto authorIds = reinterpret_cast<const char *>(valid.GetAuthorIds().data());
+    const auto offset = static_cast<size_t>(authorIds - reinterpret_cast<const char *>(valid.GetRatings().data()));
+    const auto ratingsOffset = sizeof(details::SnapshotHeader);
+    Corrupt(ratingsOffset + offset, 100);
+    EXPECT_THROW(Snapshot(path, Snapshot::Verify::Full), std::runtime_error);
+    EXPECT_NO_THROW(Snapshot(path, Snapshot::Verify::Header));
+}
+
+TEST_F(SnapshotTest, RejectsCorruptHeaderCounts) {
+    // authors = UINT64_MAX: authors + 1 переполнился бы в ноль
+    for (size_t i = 0; i < sizeof(uint64_t); ++i)
+        Corrupt(offsetof(details::SnapshotHeader, authors) + i, '\xff');
+    EXPECT_THROW(Snapshot(path, Snapshot::Verify::Header), std::runtime_error);
+}
+
+TEST_F(SnapshotTest, FailedSaveRemovesTemporaryFile) {
+    // Переименование поверх непустого каталога не удаётся
+    const auto dir = std::filesystem::temp_directory_path() / "bookdb_snapshot_test_dir";
+    std::filesystem::create_directories(dir / "child");
+    EXPECT_THROW(saveSnapshot(db, dir), std::filesystem::filesystem_error);
+    EXPECT_FALSE(std::filesystem::exists(dir.string() + ".tmp"));
+    std::filesystem::remove_all(dir);
+}
@@ -0,0 +1,48 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+#include "book_database.hpp"
+#include "string_arena.hpp"
+
+using namespace bookdb;
+
+TEST(StringArenaTest, StoresIntoSharedBlocks) {
+    StringArena arena(64);
+
+    const auto first = arena.Store("first");
+    const auto second = arena.Store("second");
+    EXPECT_EQ(first, "first");
+    EXPECT_EQ(second, "second");
+    EXPECT_EQ(first.data() + first.size(), second.data());
+    EXPECT_EQ(arena.GetBlockCount(), 1);
+
+    // Длинная строка не выбрасывает остаток текущего блока
+    const std::string big(100, 'x');
+    EXPECT_EQ(arena.Store(big), big);
+    EXPECT_EQ(arena.Store("third").data(), second.data() + second.size());
+    EXPECT_EQ(arena.GetBlockCount(), 2);
+
+    arena.Clear();
+    EXPECT_EQ(arena.GetBlockCount(), 0);
+}
+
+TEST(StringArenaTest, DatabaseOwnsTitlesAndAuthors) {
+    auto db = std::make_unique<BookDatabase<std::vector<Book>>>();
+    {
+        const std::string title = "Animal Farm";
+        const std::string author = "George Orwell";
+        db->EmplaceBack(title, author, 1945, Genre::Fiction, 4.4, 143);
+        db->EmplaceBack("1984", author, 1949, Genre::SciFi, 4.0, 190);
+    }
+
+    EXPECT_EQ(db->GetBooks()[0].title, "Animal Farm");
+    EXPECT_EQ(db->GetBooks()[0].author.data(), db->GetBooks()[1].author.data());
+
+    // Копия разделяет блоки арены и остаётся корректной после разрушения оригинала
+    const auto copy = *db;
+    db.reset();
+    EXPECT_EQ(copy.GetBooks()[1].title, "1984");
+    EXPECT_TRUE(copy.GetAuthors().contains("George Orwell"));
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "book_database.hpp"
+#include "catalog_generator.hpp"
+#include "columnar_book_container.hpp"
+#include "title_index.hpp"
+
+using namespace bookdb;
+
+class TitleIndexTest : public ::testing::Test {
+protected:
+    BookDatabase<std::vector<Book>> db;
+
+    void SetUp() override {
+        db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+        db.EmplaceBack("Great Expectations", "Charles Dickens", 1861, Genre::Fiction, 4.1, 90);
+        db.EnableTitleIndex();
+        db.EmplaceBack("Ungreatness", "Nobody", 2000, Genre::Unknown, 2.0, 1);
+        db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+    }
+
+    std::vector<RowId> Rows(std::string_view iQuery, const TitleSearchOptions &iOpt = {}) const {
+        std::vector<RowId> res;
+        for (const auto &match : searchTitles(db, iQuery, iOpt))
+            res.push_back(match.row);
+        return res;
+    }
+};
+
+TEST_F(TitleIndexTest, SubstringIsCaseInsensitiveAndRanked) {
+    ASSERT_NE(db.GetTitleIndex(), nullptr);
+
+    // Начало названия, начало слова, середина слова
+    EXPECT_EQ(Rows("great"), (std::vector<RowId>{1, 0, 2}));
+    EXPECT_EQ(Rows("GATSBY"), (std::vector<RowId>{0}));
+    EXPECT_EQ(Rows("great", {.case_sensitive = true}), (std::vector<RowId>{2}));
+    EXPECT_EQ(Rows("Great", {.case_sensitive = true}), (std::vector<RowId>{1, 0}));
+    EXPECT_TRUE(Rows("Moby").empty());
+    EXPECT_EQ(Rows("great", {.limit = 1}), (std::vector<RowId>{1}));
+}
+
+TEST_F(TitleIndexTest, PrefixAndShortQueries) {
+    EXPECT_EQ(Rows("the g", {.mode = TitleMatchMode::Prefix}), (std::vector<RowId>{0}));
+    EXPECT_EQ(Rows("gre", {.mode = TitleMatchMode::Prefix}), (std::vector<RowId>{1}));
+    // Запрос короче n-граммы проверяется по всем строкам
+    EXPECT_EQ(Rows("19"), (std::vector<RowId>{3}));
+
+    db.Clear();
+    EXPECT_EQ(db.GetTitleIndex()->GetGramCount(), 0);
+    EXPECT_TRUE(Rows("great").empty());
+}
+
+TEST(TitleIndexCatalogTest, IndexedMatchesScan) {
+    BookDatabase<ColumnarBookContainer> indexed;
+    BookDatabase<std::vector<Book>> plain;
+    generateCatalog(plain, CatalogOptions{.rows = 3000, .authors = 40});
+    for (const Book &book : plain)
+        indexed.PushBack(book);
+    indexed.EnableTitleIndex(4);
+
+    const auto *index = indexed.GetTitleIndex();
+    EXPECT_GT(index->GetGramCount(), 0);
+    EXPECT_LT(index->GetPostingBytes(), 3000 * 64);
+
+    for (std::string_view query : {"title", "Title 12", "le 7", "zzzz"}) {
+        const auto fast = searchTitles(indexed, query);
+        const auto slow = searchTitles(plain, query);
+        ASSERT_EQ(fast.size(), slow.size()) << query;
+        for (size_t i = 0; i < fast.size(); ++i)
+            EXPECT_EQ(fast[i].row, slow[i].row);
+    }
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <functional>
+
+#include "bitmap_filter.hpp"
+#include "book_database.hpp"
+#include "catalog_generator.hpp"
+#include "columnar_book_container.hpp"
+#include "cow_array.hpp"
+#include "comparators.hpp"
+#include "order_index.hpp"
+#include "query_planner.hpp"
+#include "statsistics.hpp"
+
+using namespace bookdb;
+
+namespace {
+template <typename Db, typename P>
+std::vector<BookId> liveIds(const Db &iDb, const P &iPred) {
+    std::vector<BookId> res;
+    for (RowId row = 0; row < iDb.size(); ++row)
+        if (!iDb.IsErased(row) && iPred(iDb.GetBooks()[row]))
+            res.push_back(iDb.GetBookId(row));
+    return res;
+}
+
+template <typename Db>
+std::vector<BookId> toIds(const Db &iDb, const std::vector<RowId> &iRows) {
+    std::vector<BookId> res;
+    for (RowId row : iRows)
+        res.push_back(iDb.GetBookId(row));
+    std::ranges::sort(res);
+    return res;
+}
+}  // namespace
+
+TEST(TombstoneTest, EraseAndUpdate) {
+    BookDatabase<std::vector<Book>> db;
+    db.EnableIndexes();
+    db.EnableAggregates();
+    db.EnableZoneMap(64);
+    db.EmplaceBack("Solaris", "Stanislaw Lem", 1961, Genre::SciFi, 4.5, 100);
+    db.EmplaceBack("Eden", "Stanislaw Lem", 1959, Genre::SciFi, 4.0, 50);
+    db.EmplaceBack("Emma", "Jane Austen", 1815, Genre::Fiction, 4.2, 70);
+
+    EXPECT_TRUE(db.Erase(1));
+    EXPECT_FALSE(db.Erase(1));
+    EXPECT_FALSE(db.Erase(42));
+    EXPECT_EQ(db.FindRow(1), kNoRow);
+    EXPECT_EQ(db.FindRow(2), 2);
+    EXPECT_EQ(db.GetLiveCount(), 2);
+    EXPECT_EQ(db.GetAuthorRefCounts()[0], 1);
+    EXPECT_EQ(filterBookIds(db, GenreIs(Genre::SciFi)), std::vector<RowId>{0});
+    EXPECT_EQ(countBooks(db, YearBetween(1900, 2000)), 1);
+    EXPECT_NEAR(calculateAverageRating(db), 4.35, 1e-9);
+
+    EXPECT_TRUE(db.Update(2, BookUpdate{.year = 1816, .rating = 3.0}));
+    EXPECT_FALSE(db.Update(1, BookUpdate{.rating = 5.0}));
+    EXPECT_EQ(db.GetBooks()[2].year, 1816);
+    EXPECT_EQ(db.GetBooks()[2].read_count, 70);
+    EXPECT_EQ(filterBookIds(db, YearBetween(1816, 1816)), std::vector<RowId>{2});
+    EXPECT_TRUE(filterBookIds(db, YearBetween(1815, 1815)).empty());
+    EXPECT_NEAR(calculateAverageRating(db), 3.75, 1e-9);
+    EXPECT_NEAR(db.GetZoneMap()->GetZone(0).genre_ratings[details::GenreSlot(Genre::Fiction)].first, 3.0, 1e-9);
+
+    db.Clear();
+    EXPECT_EQ(db.FindRow(0), kNoRow);
+    db.EmplaceBack("Emma", "Jane Austen", 1815, Genre::Fiction, 4.2, 70);
+    EXPECT_EQ(db.GetBookId(0), 3);
+}
+
+template <typename T>
+class TombstoneCompactionTest : public ::testing::Test {};
+
+using Containers = ::testing::Types<std::vector<Book>, ColumnarBookContainer, CowBookContainer>;
+TYPED_TEST_SUITE(TombstoneCompactionTest, Containers);
+
+// Между шагами уплотнения база продолжает принимать удаления, изменения и вставки
+TYPED_TEST(TombstoneCompactionTest, IncrementalCompactionKeepsIds) {
+    BookDatabase<TypeParam> db;
+    generateCatalog(db, CatalogOptions{.rows = 5000, .authors = 300});
+    db.EnableIndexes();
+    db.EnableAggregates();
+    db.template EnableOrderIndex<comp::GreaterByRating>();
+    db.EnableZoneMap(256);
+    for (BookId id = 0; id < 5000; id += 3)
+        db.Erase(id);
+
+    size_t steps = 0;
+    std::optional<CompactionStats> stats;
+    for (BookId id = 1; !(stats = db.CompactStep(700)); id += 301, ++steps) {
+        EXPECT_TRUE(db.IsCompacting());
+        db.Erase(id);
+        db.Update(id + 1, BookUpdate{.year = 2024, .read_count = 7});
+        db.EmplaceBack("New", "Fresh Author", 2025, Genre::Mystery, 5.0, 1);
+    }
+    EXPECT_GT(steps, 5);
+    EXPECT_FALSE(db.IsCompacting());
+    // Удаления уже перенесённых строк остаются в маске до следующего уплотнения
+    EXPECT_LE(db.GetErasedCount(), steps);
+    EXPECT_GT(stats->rows_removed, 1666);
+    EXPECT_LE(stats->bytes_after, stats->bytes_before);
+
+    for (RowId row = 0; row < db.size(); ++row)
+        EXPECT_EQ(db.FindRow(db.GetBookId(row)), db.IsErased(row) ? kNoRow : row);
+    EXPECT_EQ(db.FindRow(0), kNoRow);
+    EXPECT_EQ(db.FindRow(1), kNoRow);
+    EXPECT_EQ(db.GetBooks()[db.FindRow(2)].year, 2024);
+    EXPECT_EQ(toIds(db, filterBookIds(db, YearBetween(2024, 2025))), liveIds(db, YearBetween(2024, 2025)));
+    EXPECT_EQ(db.GetAggregates()->GetAuthorCounts().size(), db.GetAuthors().size());
+    EXPECT_EQ(buildAuthorHistogramDense(db).size(), db.GetAuthors().size());
+    EXPECT_EQ(db.template GetOrderIndex<comp::GreaterByRating>()->size(), db.GetLiveCount());
+    EXPECT_EQ(db.GetZoneMap()->size(), db.size());
+
+    db.Compact();
+    EXPECT_EQ(db.GetErasedCount(), 0);
+    for (size_t refs : db.GetAuthorRefCounts())
+        EXPECT_GT(refs, 0);
+}
+
+TEST(TombstoneTest, ErasedRowsSkippedEverywhere) {
+    BookDatabase<std::vector<Book>> db, live;
+    generateCatalog(db, CatalogOptions{.rows = 3000, .authors = 40});
+    db.EnableOrderIndex<comp::GreaterByRating>();
+    for (BookId id = 0; id < 3000; id += 2)
+        db.Erase(id);
+    for (RowId row = 0; row < db.size(); ++row)
+        if (!db.IsErased(row))
+            live.PushBack(db.GetBooks()[row]);
+
+    const auto ordered = orderedBookIds(db, comp::GreaterByRating{}, 100);
+    const auto expected = orderedBookIds(live, comp::GreaterByRating{}, 100);
+    ASSERT_EQ(ordered.size(), 100);
+    for (size_t i = 0; i < ordered.size(); ++i) {
+        EXPECT_FALSE(db.IsErased(ordered[i]));
+        EXPECT_EQ(db.GetBooks()[ordered[i]].rating, live.GetBooks()[expected[i]].rating);
+    }
+    const auto pred = all_of(GenreIs(Genre::Fiction), RatingAbove(3.5));
+    EXPECT_EQ(countBooks(db, pred), countBooks(live, pred));
+    EXPECT_NEAR(calculateAverageRating(db), calculateAverageRating(live), 1e-9);
+    for (const auto &book : sampleRandomBooks(db, 500))
+        EXPECT_FALSE(db.IsErased(&book.get() - db.GetBooks().data()));
+    EXPECT_THROW(sampleRandomBooks(db, 2000), std::runtime_error);
+
+    // Структуры, включённые после удалений, строятся только по живым строкам
+    db.EnableIndexes();
+    db.EnableSketches();
+    live.EnableSketches();
+    EXPECT_EQ(db.GetIndexes()->ByYear().size(), live.size());
+    EXPECT_EQ(db.GetSketches()->GetRatingQuantile(0.5), live.GetSketches()->GetRatingQuantile(0.5));
+    EXPECT_EQ(db.GetSketches()->GetTopAuthors(1)[0].count, live.GetSketches()->GetTopAuthors(1)[0].count);
+
+    db.ClusterBy(comp::LessByYear{});
+    EXPECT_EQ(db.size(), live.size());
+    EXPECT_EQ(db.GetErasedCount(), 0);
+    EXPECT_EQ(db.FindRow(0), kNoRow);
+    EXPECT_EQ(db.GetBooks()[db.FindRow(1)].title, live.GetBooks()[0].title);
+}
+
+TEST(TombstoneTest, TopNKeepsIdsConsistent) {
+    BookDatabase<std::vector<Book>> db;
+    generateCatalog(db, CatalogOptions{.rows = 2000, .authors = 30});
+    db.EnableIndexes();
+    db.EnableOrderIndex<comp::LessByYear>();
+    const RowId best = orderedBookIds(db, comp::GreaterByRating{}, 1).front();
+    const BookId bestId = db.GetBookId(best);
+    db.Erase(bestId);
+    const BookId probe = db.GetBookId(best == 0 ? 1 : 0);
+    const Book probeBook = db.GetBooks()[db.FindRow(probe)];
+
+    const auto top = getTopNBy(db, 10, comp::GreaterByRating{});
+    ASSERT_EQ(top.size(), 10);
+    EXPECT_EQ(db.GetErasedCount(), 0);
+    EXPECT_EQ(db.FindRow(bestId), kNoRow);
+    EXPECT_TRUE(std::ranges::is_sorted(top, std::greater{}, &Book::rating));
+    for (RowId row = 0; row < top.size(); ++row)
+        EXPECT_NE(db.GetBookId(row), bestId);
+    for (RowId row = 0; row < db.size(); ++row)
+        EXPECT_EQ(db.FindRow(db.GetBookId(row)), row);
+
+    // Изменение по BookId попадает в ту же книгу, что и до перестановки
+    EXPECT_EQ(db.GetBooks()[db.FindRow(probe)], probeBook);
+    ASSERT_TRUE(db.Update(probe, BookUpdate{.year = 1111}));
+    EXPECT_EQ(db.GetBooks()[db.FindRow(probe)].title, probeBook.title);
+    EXPECT_EQ(orderedBookIds(db, comp::LessByYear{}, 1).front(), db.FindRow(probe));
+    EXPECT_THROW(getTopNBy(db, db.size() + 1, comp::GreaterByRating{}), std::runtime_error);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <random>
+#include <utility>
+
+#include "book_database.hpp"
+#include "columnar_book_container.hpp"
+#include "comparators.hpp"
+#include "top_k.hpp"
+
+using namespace bookdb;
+
+// Колоночное хранилище сравнивается по колонке ключей, без сборки Book
+static_assert(details::HasKeyColumn<comp::GreaterByReadCount, ColumnarBookContainer>);
+static_assert(details::HasKeyColumn<comp::LessByAuthor, ColumnarBookContainer>);
+static_assert(!details::HasKeyColumn<comp::GreaterByReadCount, std::vector<Book>>);
+static_assert(!details::HasKeyColumn<comp::LessByAuthorRank, ColumnarBookContainer>);
+
+TEST(TopKTest, DoesNotReorderDatabase) {
+    BookDatabase<std::vector<Book>> db;
+    db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+    db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+    db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+    const auto &cdb = db;
+
+    auto top = getTopKBy(cdb, 2, comp::GreaterByRating{});
+
+    ASSERT_EQ(top.size(), 2);
+    EXPECT_EQ(top[0].get().title, "The Great Gatsby");
+    EXPECT_EQ(top[1].get().title, "Animal Farm");
+    EXPECT_EQ(db.GetBooks().front().title, "1984");
+    EXPECT_THROW(getTopKBy(cdb, 4, comp::GreaterByRating{}), std::runtime_error);
+}
+
+TEST(TopKTest, ParallelMatchesFullSort) {
+    BookDatabase<ColumnarBookContainer> db;
+    std::mt19937 gen{5};
+    std::uniform_int_distribution<int> reads(0, 1000);
+    for (int i = 0; i < 20'000; ++i)
+        db.EmplaceBack("Title", "Author", 2000, Genre::Fiction, 0., reads(gen));
+
+    // Много равных значений: порядок при равенстве задаётся номером строки
+    std::vector<RowId> expected(db.size());
+    std::iota(expected.begin(), expected.end(), RowId{0});
+    const auto reads_col = db.GetBooks().GetReadCounts();
+    std::stable_sort(expected.begin(), expected.end(),
+                     [&](RowId l, RowId r) { return reads_col[l] > reads_col[r]; });
+    expected.resize(100);
+
+    ThreadPool pool{4};
+    const Parallelism par{.threads = 6, .pool = &pool, .min_part_size = 512};
+    EXPECT_EQ(getTopKRowIds(db, 100, comp::GreaterByReadCount{}, par), expected);
+    EXPECT_EQ(getTopKRowIds(db, 100, comp::GreaterByReadCount{}, {.threads = 1}), expected);
+}
+
+TEST(TopKTest, SkipsErasedBooks) {
+    BookDatabase<std::vector<Book>> db;
+    db.EmplaceBack("1984", "George Orwell", 1949, Genre::SciFi, 4.0, 190);
+    db.EmplaceBack("Animal Farm", "George Orwell", 1945, Genre::Fiction, 4.4, 143);
+    db.EmplaceBack("The Great Gatsby", "F. Scott Fitzgerald", 1925, Genre::Fiction, 4.5, 120);
+    db.Erase(2);
+
+    const auto top = getTopKBy(std::as_const(db), 2, comp::GreaterByRating{});
+    ASSERT_EQ(top.size(), 2);
+    EXPECT_EQ(top[0].get().title, "Animal Farm");
+    EXPECT_EQ(top[1].get().title, "1984");
+    EXPECT_THROW(getTopKRowIds(db, 3, comp::GreaterByRating{}), std::runtime_error);
+}
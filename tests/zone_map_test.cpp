@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "bitmap_filter.hpp"
+#include "book_database.hpp"
+#include "catalog_generator.hpp"
+#include "columnar_book_container.hpp"
+#include "cow_array.hpp"
+#include "comparators.hpp"
+#include "query_planner.hpp"
+#include "statsistics.hpp"
+#include "zone_map.hpp"
+
+using namespace bookdb;
+
+TEST(ZoneMapTest, BlockSummaries) {
+    BookDatabase<std::vector<Book>> db;
+    db.EnableZoneMap(64);
+    for (int i = 0; i < 100; ++i)
+        db.EmplaceBack("Title", "Author", 1900 + i, i < 64 ? Genre::Fiction : Genre::SciFi, 4.0, i);
+
+    const ZoneMap *zones = db.GetZoneMap();
+    ASSERT_NE(zones, nullptr);
+    ASSERT_EQ(zones->GetBlockCount(), 2);
+    const Zone &first = zones->GetZone(0);
+    EXPECT_EQ(first.rows, 64);
+    EXPECT_EQ(first.min_year, 1900);
+    EXPECT_EQ(first.max_year, 1963);
+    EXPECT_EQ(first.max_read_count, 63);
+    EXPECT_EQ(first.genre_mask, Zone::GenreBit(Genre::Fiction));
+    EXPECT_EQ(zones->GetZone(1).rows, 36);
+
+    EXPECT_EQ(details::CheckZone(first, YearBetween(1990, 2000)), ZoneMatch::None);
+    EXPECT_EQ(details::CheckZone(first, YearBetween(1800, 2000)), ZoneMatch::All);
+    EXPECT_EQ(details::CheckZone(first, YearBetween(1950, 2000)), ZoneMatch::Partial);
+    EXPECT_EQ(details::CheckZone(first, GenreIs(Genre::Fiction)), ZoneMatch::All);
+    EXPECT_EQ(details::CheckZone(first, all_of(GenreIs(Genre::Fiction), RatingAbove(4.5))), ZoneMatch::None);
+    EXPECT_EQ(details::CheckZone(first, any_of(GenreIs(Genre::SciFi), RatingAbove(3.))), ZoneMatch::All);
+    EXPECT_EQ(details::CheckZone(first, AuthorIs("Author")), ZoneMatch::Partial);
+    EXPECT_THROW(ZoneMap(100), std::runtime_error);
+
+    db.Clear();
+    EXPECT_EQ(zones->GetBlockCount(), 0);
+}
+
+template <typename T>
+class ZoneMapFilterTest : public ::testing::Test {};
+
+using Containers = ::testing::Types<std::vector<Book>, ColumnarBookContainer, CowBookContainer>;
+TYPED_TEST_SUITE(ZoneMapFilterTest, Containers);
+
+TYPED_TEST(ZoneMapFilterTest, SameResultsAsFullScan) {
+    BookDatabase<TypeParam> plain, zoned;
+    generateCatalog(plain, CatalogOptions{.rows = 20000, .authors = 200});
+    generateCatalog(zoned, CatalogOptions{.rows = 20000, .authors = 200});
+    zoned.EnableZoneMap(256);
+    zoned.ClusterBy(comp::LessByYear{});
+    plain.ClusterBy(comp::LessByYear{});
+    EXPECT_EQ(zoned.GetZoneMap()->size(), zoned.size());
+
+    const auto recent = all_of(YearBetween(2000, 2010), RatingAbove(4.));
+    const auto either = any_of(GenreIs(Genre::Mystery), YearBetween(1800, 1820));
+    EXPECT_EQ(filterBookIds(zoned, recent), filterBookIds(plain, recent));
+    EXPECT_EQ(filterBookIds(zoned, either), filterBookIds(plain, either));
+    EXPECT_EQ(countBooks(zoned, YearBetween(1900, 1950)), countBooks(plain, YearBetween(1900, 1950)));
+    EXPECT_EQ(selectBooks(zoned, GenreIs(Genre::SciFi)).ToIndices(),
+              selectBooks(plain, GenreIs(Genre::SciFi)).ToIndices());
+
+    const auto byGenre = calculateGenreRatings(zoned, YearBetween(1850, 1900));
+    const auto expected = calculateGenreRatings(plain, YearBetween(1850, 1900));
+    for (const auto &[genre, rating] : expected)
+        EXPECT_NEAR(byGenre.at(genre), rating, 1e-9);
+
+    // После кластеризации по году отсекаются почти все блоки
+    const ZoneMap &zones = *zoned.GetZoneMap();
+    EXPECT_LT(zones.CountPartialRows(YearBetween(2000, 2010)), zoned.size() / 10);
+}
+
+TEST(ZoneMapTest, ClusterByRebuildsRowIndexes) {
+    BookDatabase<std::vector<Book>> db;
+    generateCatalog(db, CatalogOptions{.rows = 3000, .authors = 50});
+    db.EnableIndexes();
+    db.EnableOrderIndex<comp::GreaterByRating>();
+    db.EnableZoneMap(128);
+    db.ClusterBy(comp::LessByGenre{});
+
+    EXPECT_TRUE(std::ranges::is_sorted(db, comp::LessByGenre{}));
+    const auto rows = db.GetOrderIndex<comp::GreaterByRating>()->Rows();
+    EXPECT_TRUE(std::ranges::is_sorted(rows, comp::GreaterByRating{}, [&](RowId row) { return db.GetBooks()[row]; }));
+    for (RowId row : db.GetIndexes()->ByGenre(Genre::Biography))
+        EXPECT_EQ(db.GetBooks()[row].genre, Genre::Biography);
+    EXPECT_LE(db.GetZoneMap()->CountPartialRows(GenreIs(Genre::Biography)), 2 * 128);
+}